@@ -29,6 +29,9 @@
  * UART Interface:<br>
  *   U0TX (PA1) and U0RX (PA0) are connected to the 2nd controller<br>
  *   U1TX (PA1) and U1RX (PA0) are used for DMX Data Transmit and Receive<br>
+ *   PC6 enables the RS-485 driver of U1TX<br>
+ *   U7RX (PE0) is the second DMX input in merge mode, UART7 TX (PE1) is not used as an output while merging<br>
+ *   PD6 (WT5CCP0) is jumpered to U1RX (PC4) to time the break and mark after break of received frames<br>
  * Other Interface:<br>
  *   PD0, PD1, PD2, PD3 is connected to a mux that reads the value from a DIP switch<br>
  *   PF1, PF2, PF3 are also configured as PWM outputs to control servos and LEDs on-board.<br>
@@ -36,7 +39,7 @@
  *   PD6, PD7 will be connected to a ESP8266-01 that will serve a webpage for UART communication so that launchpad can be controlled without
  *   physically using a USB cable.<br>
  * The USB on the 2nd controller enumerates to an ICDI interface and a virtual COM port<br>
- * Configured to 115,200 baud, 8N1<br>
+ * Configured to 115,200 baud, 8N1, or the rate stored by the baud command<br>
  */
 
 
@@ -86,26 +89,369 @@
 
 #define delay6Cycles() __asm(" NOP\n NOP\n NOP\n NOP\n NOP\n NOP\n") /*!< Delaying for 6 cycles */
 
+#define disableInterrupts() __asm(" CPSID I") /*!< Masking all maskable interrupts */
+
+#define enableInterrupts() __asm(" CPSIE I") /*!< Unmasking interrupts */
+
+#define waitForInterrupt() __asm(" WFI") /*!< Sleeping until the next interrupt */
+
+#define CONSOLE_BASEPRI (2 << 5)
+/*!< BASEPRI value that masks UART0 (priority 2) and Timer2 (priority 3) but leaves the DMX interrupts running */
+
+#define maskEffects() (NVIC_DIS0_R = 1 << (INT_TIMER2A - 16)) /*!< Holding off Timer2ISR, which steps the effects and fades */
+
+#define unmaskEffects() (NVIC_EN0_R = 1 << (INT_TIMER2A - 16)) /*!< Letting Timer2ISR run again, a trigger held off runs now */
+
+#define FIELD_SIZE 20
+/*!< Size of the command and argument fields of the console, including the terminator */
+
+#define TX0_SIZE 4096
+/*!< Console transmit ring size, a power of 2 larger than the boot banner and help text together (about 2.2 KB) */
+
+#define RX0_SIZE 1024
+/*!< Console receive ring size, a power of 2 larger than the largest show image record */
+
+#define FRAME_START 0xA5
+/*!< First byte of a binary console frame. Never typed at the console, so it can arrive between command lines. */
+
+#define FRAME_WRITE 0x01
+/*!< Frame opcode to write slots to the back universes */
+
+#define FRAME_READ 0x02
+/*!< Frame opcode to read slots from the front universes */
+
+#define FRAME_BAUD 0x03
+/*!< Frame opcode to change the UART0 baud rate, after the reply */
+
+#define FRAME_ERROR 0xFF
+/*!< Reply opcode of a rejected frame. The offset field holds the reason. 1: CRC, 2: Range, 3: Opcode, 4: Mode */
+
+#define FRAME_TIMEOUT 400000
+/*!< Gap in a binary frame after which it is abandoned, 10 ms in clock cycles */
+
+#define ENTTEC_START 0x7E
+/*!< First byte of an Enttec DMX USB Pro packet */
+
+#define ENTTEC_END 0xE7
+/*!< Last byte of an Enttec DMX USB Pro packet */
+
+#define CONSOLE_BAUD 115200
+/*!< UART0 baud rate until the baud command stores another one in EEPROM */
+
+#define COMMANDS 43
+/*!< Number of console commands, indexes of commandNames */
+
+#define COMMAND_HASH 128
+/*!< Buckets of the console command hash table, a power of 2 well above COMMANDS */
+
+/*
+ * Console command numbers, indexes of commandNames. 0 is an unknown command.
+ */
+#define CMD_DEVICE 1
+#define CMD_SECONDS 2
+#define CMD_STARTEND 3
+#define CMD_WOO 4
+#define CMD_CLEAR 5
+#define CMD_SET 6
+#define CMD_GET 7
+#define CMD_MAX 8
+#define CMD_UNIVERSE 9
+#define CMD_FADE 10
+#define CMD_EFFECTS 11
+#define CMD_GEN 12
+#define CMD_GENP 13
+#define CMD_RECORD 14
+#define CMD_CUE 15
+#define CMD_WAIT 16
+#define CMD_GO 17
+#define CMD_STOP 18
+#define CMD_LOAD 19
+#define CMD_ENTTEC 20
+#define CMD_TXMODE 21
+#define CMD_BREAK 22
+#define CMD_MAB 23
+#define CMD_RATE 24
+#define CMD_AUTOSLOTS 25
+#define CMD_FPS 26
+#define CMD_TXSTAT 27
+#define CMD_ON 28
+#define CMD_OFF 29
+#define CMD_CONTROLLER 30
+#define CMD_RXMODE 31
+#define CMD_REPEAT 32
+#define CMD_MERGE 33
+#define CMD_STATS 34
+#define CMD_ADDRESS 35
+#define CMD_PERSONALITY 36
+#define CMD_PERIOD 37
+#define CMD_CURVE 38
+#define CMD_FILL 39
+#define CMD_COPY 40
+#define CMD_RAMP 41
+#define CMD_PATTERN 42
+#define CMD_BAUD 43
+
+#define TIMESTAMP TIMER0_TAV_R
+/*!< Free running 40 MHz timestamp from Timer0, in clock cycles */
+
+#define UDMA_CH_UART1TX 23
+/*!< uDMA channel used for UART1 TX (channel 23, encoding 0) */
+
+#define UDMA_CH_UART1RX 22
+/*!< uDMA channel used for UART1 RX (channel 22, encoding 0) */
+
+#define DMX_PORTS 6
+/*!< Number of DMX outputs. Universe 1: UART1 (PC5), 2: UART2 (PD7), 3: UART3 (PC7), 4: UART5 (PE5), 5: UART6 (PD5), 6: UART7 (PE1).
+ UART4 is not used since its TX pin PC5 is taken by UART1. */
+
+#define MERGE_TIMEOUT 40000000
+/*!< A merge input that has not sent a frame for 1 s (in clock cycles) no longer takes part in the merge */
+
+#define MERGE_PORT 5
+/*!< Port whose UART receives merge input B (UART7, universe 6). The merge is sent on the ports below it. */
+
+#define BREAK_MAX 10000
+/*!< Longest break the break command accepts, 10 ms in microseconds */
+
+#define MAB_MAX 10000
+/*!< Longest mark after break the mab command accepts, 10 ms in microseconds */
+
+#define GENERATORS 8
+/*!< Number of effect generators */
+
+#define PWM_PERIOD 50000
+/*!< Default PWM1 generator load value, 40 MHz / 16 / 50000 = 50 Hz for servo control */
+
+#define PWM_PERIOD_16 65535
+/*!< Default PWM1 generator load value of the 16-bit personality, 40 MHz / 65535 = 610 Hz */
+
+#define SCENE_BASE 0x00038000
+/*!< Flash address of scene 0. Scenes are 512 bytes, two per 1 KB flash page. The linker keeps code below this address. */
+
+#define SCENES 48
+/*!< Number of scenes, 0x38000 to 0x3DFFF */
+
+#define CUE_BASE 0x0003E000
+/*!< Flash page holding the cue list */
+
+#define CUES 128
+/*!< Number of cues, 8 bytes each, one flash page */
+
+#define SHOW_VERSION 2
+/*!< Show image version taken by the load command. Version 2 added the sum at the end of each scene record. */
+
+#define UART_REG(base, offset) (*((volatile uint32_t *)((base) + (offset))))
+/*!< Register of the UART at the given base address */
+
+#define UART_O_DR 0x000
+/*!< UART Data register offset */
+
+#define UART_O_FR 0x018
+/*!< UART Flag register offset */
+
+#define UART_O_IBRD 0x024
+/*!< UART Integer Baud-Rate Divisor register offset */
+
+#define UART_O_FBRD 0x028
+/*!< UART Fractional Baud-Rate Divisor register offset */
+
+#define UART_O_LCRH 0x02C
+/*!< UART Line Control register offset */
+
+#define UART_O_CTL 0x030
+/*!< UART Control register offset */
+
+#define UART_O_IFLS 0x034
+/*!< UART Interrupt FIFO Level Select register offset */
+
+#define UART_O_IM 0x038
+/*!< UART Interrupt Mask register offset */
+
+#define UART_O_ICR 0x044
+/*!< UART Interrupt Clear register offset */
+
+#define UART_O_CC 0xFC8
+/*!< UART Clock Configuration register offset */
+
+#define dmxData (ports[0].back)
+/*!< Back universe of universe 1. All writers (commands, special functions, receiver) write bins of DMX data here. */
+
+#define dmxFront (ports[0].front)
+/*!< Front universe of universe 1. Transmitted in controller mode and read by the outputs in device mode. */
+
+/**
+ * @brief
+ *
+ * DMX output port: a UART with its own double buffered universe and slot count.
+ * Break and mark after break of all ports are timed together by Timer1.
+ */
+typedef struct
+{
+    uint32_t base; /*!< Base address of the UART registers. */
+    uint32_t buffer[2][129]; /*!< Front and back universes. The last byte of word 0 holds the start code so it directly precedes the 512 word aligned bins. */
+    uint8_t* back; /*!< Back universe. Writers write bins of DMX data here. */
+    uint8_t* front; /*!< Front universe. Bins of DMX data being transmitted. */
+    volatile uint8_t dirty; /*!< Flag to indicate that the back universe has changes that are not in the front universe yet. */
+    volatile uint8_t stale; /*!< Flag to indicate that the back universe is one swap behind the front universe and must be synced before writing. */
+    volatile uint8_t writing; /*!< Number of writers currently updating the back universe. Universes are not swapped while non-zero. */
+    uint8_t enabled; /*!< Flag to indicate whether the port transmits. Universe 1 is always enabled. */
+    uint16_t backSlots; /*!< Highest non-zero bin of the back universe. */
+    uint16_t frontSlots; /*!< Highest non-zero bin of the front universe. */
+    uint16_t maxSlots; /*!< Maximum Number of DMX Bins to Transmit. */
+    uint16_t slots; /*!< Number of DMX Bins in the frame being transmitted. Latched at the break. */
+    uint16_t next; /*!< Next bin to be queued in the TX FIFO. */
+} dmxPort;
+
+/**
+ * @brief
+ *
+ * Receive line health counters. Updated once per frame or per error by the receive path, never per slot.
+ */
+typedef struct
+{
+    uint32_t frames; /*!< Frames committed to the outputs. */
+    uint32_t dropped; /*!< Frames discarded for errors or fewer than 24 slots. */
+    uint32_t breaks; /*!< Breaks received. */
+    uint32_t framingErrors; /*!< Characters received with a framing error. */
+    uint32_t overruns; /*!< UART1 receive FIFO overruns. */
+    uint32_t startCodes; /*!< Frames ignored for a non-zero (alternate) start code. */
+    uint32_t histogram[8]; /*!< Committed frames by slot count, 64 slots per bucket. */
+    uint16_t slots; /*!< Number of DMX Bins in the last committed frame. */
+    uint16_t fps; /*!< Frames committed during the last complete one second window. */
+    uint16_t windowFrames; /*!< Frames committed in the current one second window. */
+    uint32_t windowStart; /*!< Timestamp of the start of the current one second window. */
+    uint32_t period; /*!< Last break to break period, in clock cycles. Measured from the captured edges when PD6 is jumpered to U1RX. */
+    uint32_t breakTicks; /*!< Last captured break, in clock cycles. */
+    uint32_t mabTicks; /*!< Last captured mark after break, in clock cycles. */
+    uint32_t badBreaks; /*!< Frames ignored for a captured break or mark after break out of spec. */
+    uint32_t lastBreak; /*!< Timestamp of the last break. */
+    uint32_t lastGood; /*!< Timestamp of the last committed frame. */
+} rxStatistics;
+
+/**
+ * @brief
+ *
+ * Effect generator: one waveform applied to a range of channels of universe 1, stepped once per frame.
+ * Phases are 16 bit, the top 8 bits index the waveform table. Rate and amplitude belong to the generator, so every
+ * channel of the range moves at the same speed and depth; only the phase changes from channel to channel (spread).
+ * Channels that need another rate or amplitude go on another generator over their own range.
+ */
+typedef struct
+{
+    const uint8_t* wave; /*!< Waveform table, 0 when the generator is off. */
+    uint16_t first; /*!< First channel, 0 based. */
+    uint16_t last; /*!< Last channel, 0 based. */
+    uint16_t phase; /*!< Phase of the first channel. */
+    uint16_t rate; /*!< Phase advance per frame. 256 is one table entry. */
+    uint16_t spread; /*!< Phase offset from one channel to the next. */
+    uint16_t amplitude; /*!< Output scale, 0 to 256. */
+} effectGenerator;
+
+/**
+ * @brief
+ *
+ * Cue: a scene with split crossfade times and an optional wait before the next cue follows. Times are in 10 ms ticks.
+ */
+typedef struct
+{
+    uint8_t scene; /*!< Scene faded to. */
+    uint8_t used; /*!< 1 when the cue is programmed. Erased flash reads 0xFF. */
+    uint16_t fadeIn; /*!< Time for channels going up. */
+    uint16_t fadeOut; /*!< Time for channels going down. */
+    uint16_t wait; /*!< Time after the fade before the next cue follows, 0 to wait for go. */
+} cue;
+
 
 /*
  * UART0 Global Variables
  * ========================
  */
 
-char command[20]; /*!< To Store characters from UART0 command*/
-char arg1[20]; /*!< To Store characters from UART0 command 1st Argument*/
-char arg2[20]; /*!< To Store characters from UART0 command 2nd Argument*/
-int8_t enteringField = 0; /*!< Iterates over the different command fields while entering a command. 0: Command, 1: 1st Argument, 2: 2nd Argument*/
+char command[FIELD_SIZE]; /*!< To Store characters from UART0 command*/
+char arg1[FIELD_SIZE]; /*!< To Store characters from UART0 command 1st Argument*/
+char arg2[FIELD_SIZE]; /*!< To Store characters from UART0 command 2nd Argument*/
+char arg3[FIELD_SIZE]; /*!< To Store characters from UART0 command 3rd Argument*/
+char arg4[FIELD_SIZE]; /*!< To Store characters from UART0 command 4th Argument*/
+int8_t enteringField = 0; /*!< Iterates over the different command fields while entering a command. 0: Command, 1: 1st Argument, 2: 2nd Argument, 3: 3rd Argument, 4: 4th Argument*/
 int8_t pos = 0; /*!< Position of the character in the entering field. */
+uint8_t dropLine = 0; /*!< Flag to ignore the rest of a line that had a field too long, up to the end of the line. */
+char tx0Buffer[TX0_SIZE]; /*!< Console output waiting for room in the UART0 FIFO. */
+volatile uint16_t tx0Head = 0; /*!< Next free position of the console transmit ring. */
+volatile uint16_t tx0Tail = 0; /*!< Next character of the console transmit ring to send. */
+uint32_t tx0Overflows = 0; /*!< Console characters dropped because the transmit ring was full. */
+uint8_t rx0Buffer[RX0_SIZE]; /*!< Console input waiting for the main loop. */
+volatile uint16_t rx0Head = 0; /*!< Next free position of the console receive ring, only written by Uart0Isr. */
+volatile uint16_t rx0Tail = 0; /*!< Next character of the console receive ring, only written by the main loop. */
+uint32_t rx0Overflows = 0; /*!< Console characters dropped because the receive ring was full. */
+uint32_t uart0IsrMax = 0; /*!< Longest Uart0Isr, in clock cycles. */
+uint8_t frameState = 0; /*!< Binary frame receive state. 0: Idle, 1: Header, 2: Payload, 3: CRC */
+uint8_t frameHeader[5]; /*!< Opcode, offset and length of the frame being received. */
+uint8_t frameData[512]; /*!< Payload of the frame being received, applied once the CRC matches. */
+uint16_t framePos = 0; /*!< Position in the header, payload or CRC. */
+uint16_t frameLength = 0; /*!< Payload length of the frame being received. */
+uint16_t frameCrc = 0; /*!< Running CRC of the frame being received. */
+uint16_t frameCrcIn = 0; /*!< CRC received at the end of the frame. */
+uint32_t frameLast = 0; /*!< Timestamp of the last byte of the frame being received. */
+const char* const commandNames[COMMANDS + 1] = { "",
+        "device", "seconds", "startend", "woo", "clear", "set", "get", "max", "universe", "fade", "effects", "gen",
+        "genp", "record", "cue", "wait", "go", "stop", "load", "enttec", "txmode", "break", "mab", "rate",
+        "autoslots", "fps", "txstat", "on", "off", "controller", "rxmode", "repeat", "merge", "stats", "address",
+        "personality", "period", "curve", "fill", "copy", "ramp", "pattern", "baud" }; /*!< Console command names by CMD_ number. */
+uint8_t commandHash[COMMAND_HASH]; /*!< CMD_ number of each command name by hash, 0 for an empty bucket. Built at reset. */
+uint8_t enttec = 0; /*!< Flag to accept Enttec DMX USB Pro packets on UART0 alongside the console. */
+uint8_t enttecState = 0; /*!< Enttec packet receive state. 0: Idle, 1: Label, 2: Length low, 3: Length high, 4: Data, 5: End */
+uint8_t enttecLabel = 0; /*!< Label of the Enttec packet being received. */
+uint16_t enttecLength = 0; /*!< Data length of the Enttec packet being received. */
+uint16_t enttecPos = 0; /*!< Position in the data of the Enttec packet being received. */
+uint8_t enttecParams[5]; /*!< Set widget parameters data: user size, break, mark after break and rate. */
+uint32_t enttecLast = 0; /*!< Timestamp of the last byte of the Enttec packet being received. */
+uint32_t enttecFrames = 0; /*!< Received frame count at the last received DMX packet sent to the host. */
+uint8_t loading = 0; /*!< Show image load state, 0 while UART0 is the console. 1: Header, 2: Record type, 3: Record, 4: Scene number, 5: Run header, 6: Run levels, 7: Scene sum */
+uint8_t loadType = 0; /*!< Type of the show image record being received. 'S': Scene, 'C': Cue, 'G': Generator, 'E': End */
+uint8_t loadRecord[12]; /*!< Bytes of the fixed size record or run header being received. */
+uint16_t loadPos = 0; /*!< Position in the header, record or run. */
+uint16_t loadLength = 0; /*!< Length of the record or run being received. */
+uint16_t loadStart = 0; /*!< First channel of the scene run being received. */
+uint16_t loadSum = 0; /*!< Sum of the image bytes received, checked by the end record. */
+uint16_t loadSceneSum = 0; /*!< Sum of the bytes of the scene record being received, checked before it is written to flash. */
+uint8_t loadSceneNumber = 0; /*!< Scene being received. */
+uint8_t loadScenes = 0; /*!< Scenes written by this load. */
+uint8_t loadCues = 0; /*!< Cues changed by this load. */
+uint32_t loadScene[128]; /*!< Scene being decoded. Scene runs are deltas against the previous scene of the image, so it is kept between scenes. */
 
 /*
  * DMX Transmit Global Variables
  * ========================
  */
 
-uint16_t maxAddress = 512; /*!< Maximum Number of DMX Bins to Transmit. */
+uint16_t txSlots = 512; /*!< Number of DMX Bins in the longest frame currently being transmitted. Latched at the break. */
+uint8_t autoSlots = 0; /*!< Flag to trim each frame to the highest non-zero bin (at least 24 bins) instead of always sending the maximum number of bins. */
+uint32_t txGap = 0; /*!< Idle time scheduled after the last frame, before the next break, in microseconds. */
+uint16_t refreshRate = 0; /*!< Target frames per second. 0: As fast as the slot count and break/MAB settings allow. */
 uint8_t continuous = 0; /*!< Flag to indicate whether transmit of DMX is enabled or not. */
-uint16_t DMXMode = 0; /*!< Mode to indicate what is being transmitted. 0: Break, 1: Mark After Break, 2: Start Code, > 2: DMX Data bins */
+uint16_t DMXMode = 0; /*!< Mode to indicate what is being transmitted on all ports. 0: Idle, 1: Break, 2: Mark After Break, 3: Start Code and DMX Data bins */
+uint8_t txPorts = 1; /*!< Bit per port enabled at the last break. The mark after break and the start code go to the same ports, even if a universe is switched on or off mid frame. */
+uint8_t portsBusy = 0; /*!< Bit per port that has not finished transmitting the current frame. The next break starts once it is 0. */
+uint8_t flashHold = 0; /*!< Output held for a flash erase or program. 0: No, 1: Waiting for the frame to end, 2: Stopped before the break. */
+uint8_t txMode = 0; /*!< Transmit engine. 0: One UART1 TX interrupt per slot, 1: uDMA streams the slots and UART1 only interrupts at the end of the frame,
+ 2: UART1 TX FIFO is refilled with up to 14 slots per interrupt. */
+uint8_t txUartMode = 0xFF; /*!< Transmit engine UART1 is currently configured for. 0xFF: UART1 needs to be configured at the next break. */
+uint16_t breakTime = 176; /*!< Duration of the break in microseconds. */
+uint16_t mabTime = 12; /*!< Duration of the mark after break in microseconds. */
+uint32_t txIsrCount = 0; /*!< Number of UART1 interrupts taken by the frame currently being transmitted. */
+uint32_t txIsrPerFrame = 0; /*!< Number of UART1 interrupts taken by the last complete frame. */
+uint32_t txFrames = 0; /*!< Number of complete frames transmitted. */
+uint32_t lastBreak = 0; /*!< Timestamp of the last break. */
+uint8_t lastBreakValid = 0; /*!< Flag to indicate whether lastBreak belongs to the previous frame of a continuous transmission. */
+uint32_t fpsWindowStart = 0; /*!< Timestamp of the start of the current one second measurement window. */
+uint16_t fpsWindowFrames = 0; /*!< Frames started in the current measurement window. */
+uint32_t fpsWindowMin = 0xFFFFFFFF; /*!< Shortest break to break period in the current measurement window, in clock cycles. */
+uint32_t fpsWindowMax = 0; /*!< Longest break to break period in the current measurement window, in clock cycles. */
+uint16_t achievedFps = 0; /*!< Frames transmitted during the last complete measurement window. */
+uint32_t frameJitter = 0; /*!< Difference between longest and shortest frame period during the last complete measurement window, in clock cycles. */
+
+#pragma DATA_ALIGN(udmaControlTable, 1024)
+uint32_t udmaControlTable[256]; /*!< uDMA channel control table. 4 words per channel: source end, destination end, control word, unused. */
 
 /*
  * DMX Receive Global Variables
@@ -116,6 +462,38 @@ uint16_t deviceModeAddress = 0; /*!< Device Address of the Current Receiver */
 uint8_t prevRX = 0;
 uint8_t rxError = 0; /*!< Flag to indicate whether the receiver is in error state, ie, has not received a break in 2 secs. */
 uint16_t rxState = 0; /*!< Mode to indicate what is being received. 0: Break, 1: Mark After Break, 2: Start Code, > 2: DMX Data bins. */
+uint8_t rxMode = 0; /*!< Receive engine. 0: One UART1 RX interrupt per slot, 1: uDMA lands the frame in the back universe and UART1 only interrupts at the break and end of frame. */
+uint8_t rxDmaValid = 0; /*!< Flag to indicate that the uDMA receive transfer started at a break and has had no framing or overrun error since. */
+uint8_t rxWriting = 0; /*!< Flag to indicate that the receiver holds the back universe with beginDMXWrite while a frame lands in it. */
+rxStatistics rxStats; /*!< Receive line health counters, printed by the stats command. */
+uint8_t repeat = 0; /*!< Flag to forward every received slot to UART2, 3, 5, 6, 7 as it arrives (splitter). */
+uint8_t repState = 3; /*!< Repeater output state. 0: Waiting for the outputs to finish the last frame, 1: Break, 2: Mark After Break, 3: Start Code and DMX Data bins */
+uint8_t* repSource = 0; /*!< Universe the current input frame is received into. Outputs read the slots from here. */
+volatile uint16_t repAvailable = 0; /*!< Characters of the current input frame received so far, including the start code. */
+uint32_t repInStart = 0; /*!< Timestamp of the received start code. */
+uint32_t repBreakLatency = 0; /*!< Input break to output break, in clock cycles. */
+uint32_t repSlotLatency = 0; /*!< Input start code to output start code, in clock cycles. */
+uint32_t repMaxSlotLatency = 0; /*!< Largest input start code to output start code latency, in clock cycles. */
+uint8_t repPorts = DMX_PORTS; /*!< The repeater and merge send on the ports from 1 to below this one. MERGE_PORT while merging. */
+uint8_t merge = 0; /*!< Merge mode. 0: Off, 1: HTP, 2: LTP. Inputs UART1 (A) and U7RX on PE0 (B) are merged into universe 2 and sent on UART2, 3, 5, 6. */
+uint32_t mergeBuffer[2][129]; /*!< Front and back universes of input B. The last byte of word 0 holds the start code. */
+uint8_t* mergeBack = (uint8_t*) &mergeBuffer[0][1]; /*!< Universe input B is received into. */
+uint8_t* mergeFront = (uint8_t*) &mergeBuffer[1][1]; /*!< Last complete frame of input B. */
+uint16_t mergeState = 0; /*!< Receive state of input B, same states as rxState. */
+uint16_t mergeSlotsB = 0; /*!< Number of DMX Bins in the last frame of input B. */
+uint32_t mergeLastB = 0; /*!< Timestamp of the last frame of input B. */
+uint32_t mergeFramesB = 0; /*!< Frames received on input B. */
+uint32_t ltpLast[2][128]; /*!< Last frame of input A and B, to find the channels each input changed for LTP. */
+uint32_t ltpOut[128]; /*!< LTP merge result. */
+uint16_t mergeSlots = 0; /*!< Number of DMX Bins in the merged universe. */
+uint32_t mergeTicks = 0; /*!< Clock cycles taken by the last merge. */
+uint8_t capState = 0; /*!< Break edge capture state. 0: Idle, 1: Waiting for the end of the break, 2: Waiting for the start bit of the start code */
+uint32_t capBreakStart = 0; /*!< Captured falling edge that started the last break. */
+uint32_t capMabStart = 0; /*!< Captured rising edge that ended the last break. */
+uint8_t capBreakValid = 0; /*!< Flag to indicate whether capBreakStart is the captured start of the previous break, so the next capture gives a period. */
+uint8_t rxBreakValid = 0; /*!< Flag to indicate whether rxStats.lastBreak is the previous break of an ongoing reception, so the next break gives a period. */
+uint16_t rxIsrCount = 0; /*!< UART1 receive interrupts since the last committed frame. */
+uint16_t rxIsrPerFrame = 0; /*!< UART1 receive interrupts taken by the last committed frame. */
 
 /*
  * DMX Special Functions Global Variables
@@ -123,18 +501,36 @@ uint16_t rxState = 0; /*!< Mode to indicate what is being received. 0: Break, 1:
  *
  */
 
-float seconds = 0; /*!< Used by special ramp function to indicate current second count. Timer counts up seconds every 100ms. (not very accurate) */
-int upR, upG, upB; /*!< Used by special ramp function for ramping logic */
-int goR, goG, goB; /*!< Used by special ramp function for ramping logic */
-float secondsTrigger = 0.0; /*!< Used for special ramp function to indicate the number of seconds to complete ramp. */
+cue cues[CUES]; /*!< Cue list, loaded from flash at reset and written back when a cue is changed. */
+uint32_t sceneCopy[128]; /*!< Other scene of a flash page while the page is erased and written. */
+const uint8_t sceneBlack[512] = { 0 }; /*!< Blackout, crossfaded from before the first cue. */
+uint32_t xfSnapshot[128]; /*!< Universe 1 as it was when the running cue was recalled, so a go in the middle of a crossfade fades on from the levels on the wire. */
+const uint8_t* xfFrom = sceneBlack; /*!< Scene the running cue fades from. */
+const uint8_t* xfTo = sceneBlack; /*!< Scene the running cue fades to. */
+uint8_t cueCurrent = 0; /*!< Cue being played. */
+volatile int16_t cueRequest = -1; /*!< Cue to go to at the next frame, -1 for none. Handed over so a go never lands mid-crossfade. */
+uint8_t playing = 0; /*!< Cue playback state. 0: Stopped, 1: Crossfading, 2: Waiting to follow */
+uint32_t xfTicks = 0; /*!< 10 ms ticks since the crossfade or wait started. */
+uint32_t xfLast = 0; /*!< Timestamp the cue ticks have been advanced to. */
+effectGenerator generators[GENERATORS]; /*!< Effect generators. Generator 0 runs the woo 2 ramp animation. */
+uint16_t secondsTrigger = 0; /*!< Used for special ramp function to indicate the number of seconds to complete ramp. */
 uint16_t dimStart = 0; /*!< Used for special ramp function to indicate the start value. */
 uint16_t dimEnd = 0; /*!< Used for special ramp function to indicate the stop value of ramp function. */
-float dimValue = 0; /*!< Used for special ramp function to indicate the current ramp value at time t. */
+int32_t fadeLevel[512]; /*!< Q16 level of each channel of universe 1 while it fades. */
+int32_t fadeStep[512]; /*!< Q16 change of each fading channel per fade tick. */
+uint16_t fadeTicks[512]; /*!< 10 ms fade ticks left for each fading channel. */
+uint8_t fadeTarget[512]; /*!< Value each fading channel ends at. */
+uint32_t fadeActive[16]; /*!< Bit per channel that is fading. Idle words are skipped by the tick. */
+uint32_t fadeLast = 0; /*!< Timestamp fades have been advanced to, in whole 10 ms ticks. */
+volatile uint8_t effectBusy = 0; /*!< Flag to indicate that the effects of the next frame are still being computed. */
+uint32_t effectCycles = 0; /*!< Clock cycles taken to compute the effects of the last frame. */
+uint32_t effectMax = 0; /*!< Largest number of clock cycles taken to compute the effects of a frame. */
+uint32_t effectOverruns = 0; /*!< Frames whose break came before the effects of the previous frame were computed. */
 uint8_t woo = 0; /*!< Variable to indicate what special function is running. 0: Nothing, 1: Sets all addresses to 255
  , 2: Ramp Animation using Timer2, 3: Set servo angle ([14,58] -> [0,180] degrees), 4: Sweep Servo from 0-180-0, 5: Special Timer
  based ramp control. */
 int servoDir = 0; /*!< Used by servoSweep to indicate direction of sweep. */
-char ch[3]; /*!< For storing integer to character */
+char ch[4]; /*!< For storing integer to character, 3 digits and the terminator */
 uint8_t vall = 8; /*!< For EEPROM Data */
 uint8_t incr = 1; /*!< For EEPROM Data */
 uint16_t program; /*!< For EEPROM Data */
@@ -142,12 +538,275 @@ uint16_t Address; /*!< For EEPROM Data */
 uint16_t opMode; /*!< For EEPROM Data */
 uint16_t setval; /*!< For EEPROM Data */
 
+/*
+ * DMX Effect Waveforms
+ * ========================
+ */
+
+const uint8_t waveSine[256] = {
+        128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+        176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+        218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+        245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+        255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+        245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+        218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+        176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+        128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+         79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+         37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+         10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0,
+          0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+         10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+         37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+         79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124 }; /*!< Sine, 0 to 255 centered on 127.5 */
+
+const uint8_t waveTriangle[256] = {
+          0,   2,   4,   6,   8,  10,  12,  14,  16,  18,  20,  22,  24,  26,  28,  30,
+         32,  34,  36,  38,  40,  42,  44,  46,  48,  50,  52,  54,  56,  58,  60,  62,
+         64,  66,  68,  70,  72,  74,  76,  78,  80,  82,  84,  86,  88,  90,  92,  94,
+         96,  98, 100, 102, 104, 106, 108, 110, 112, 114, 116, 118, 120, 122, 124, 126,
+        128, 130, 132, 134, 136, 138, 140, 142, 144, 146, 148, 150, 152, 154, 156, 158,
+        160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180, 182, 184, 186, 188, 190,
+        192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218, 220, 222,
+        224, 226, 228, 230, 232, 234, 236, 238, 240, 242, 244, 246, 248, 250, 252, 254,
+        255, 253, 251, 249, 247, 245, 243, 241, 239, 237, 235, 233, 231, 229, 227, 225,
+        223, 221, 219, 217, 215, 213, 211, 209, 207, 205, 203, 201, 199, 197, 195, 193,
+        191, 189, 187, 185, 183, 181, 179, 177, 175, 173, 171, 169, 167, 165, 163, 161,
+        159, 157, 155, 153, 151, 149, 147, 145, 143, 141, 139, 137, 135, 133, 131, 129,
+        127, 125, 123, 121, 119, 117, 115, 113, 111, 109, 107, 105, 103, 101,  99,  97,
+         95,  93,  91,  89,  87,  85,  83,  81,  79,  77,  75,  73,  71,  69,  67,  65,
+         63,  61,  59,  57,  55,  53,  51,  49,  47,  45,  43,  41,  39,  37,  35,  33,
+         31,  29,  27,  25,  23,  21,  19,  17,  15,  13,  11,   9,   7,   5,   3,   1 }; /*!< Triangle, up in the first half and down in the second */
+
+const uint8_t waveSquare[256] = {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 }; /*!< Square, 50% duty */
+
+const uint8_t waveSaw[256] = {
+          0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,
+         16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+         32,  33,  34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,
+         48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,
+         64,  65,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,  77,  78,  79,
+         80,  81,  82,  83,  84,  85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,
+         96,  97,  98,  99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111,
+        112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127,
+        128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+        144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+        160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+        176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+        192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207,
+        208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223,
+        224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+        240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255 }; /*!< Rising saw */
+
+const uint8_t waveRandom[256] = {
+        198, 126, 129, 107,  75, 251, 226, 251,  84, 246, 189, 223, 124,  28, 225, 135,
+          1, 191,  49, 222,  86, 114,  15,  71, 103, 102, 135,  89, 170, 136,  60,  89,
+        234,  86,  19, 123, 210, 133, 161, 216,  60,  84,  85,  47,  55, 174, 101,  91,
+        218,   2, 121, 152, 204, 227,  26, 118, 142,  95, 217, 153, 143,  31,  63,  54,
+        238,  67, 120,  77,  13, 250, 190, 166, 218, 228, 134, 142, 220,  41, 109,  78,
+        255,  86, 225, 112,  32, 251, 143, 177,  88,   5, 144, 197,   9, 220,  83, 205,
+        170,  59,  72, 153,  82, 211,  82, 157,   6, 159, 234, 181, 194,   6,  19, 152,
+         73, 178,   1,  30, 172,  50, 136,  49, 156,  82,  70, 149, 113,  54, 143,  87,
+        246,  57,  29,  22, 250, 136, 116, 245, 152, 124,  23,  92,  65, 187, 109, 113,
+        142,  15, 112,  89, 199,   1,  27,  47,  51,  61, 145, 192,  29, 165,  13,  13,
+        171,  51, 141, 126,  94, 143,  62, 230, 104, 116, 166,  58, 177, 195, 147,  17,
+        168, 100, 199, 219, 202, 224,  96, 225, 243, 191,   9,   0, 103, 162, 227,  37,
+        160,  33,  49, 135, 213,  98, 197, 168,  79, 126,  46,   9, 107, 148, 159, 176,
+        109, 169, 158,  90,  11,  70, 112, 128, 182, 207,  71,  12, 166, 165,  42, 216,
+        172, 251, 160, 235, 183, 121,  36, 114,  35, 146,  72, 128, 197, 166, 167, 133,
+        183, 215, 140, 144, 228, 171,  99,  68,  82, 102, 227, 156,  51,  37, 249,  94 }; /*!< Fixed pseudo random levels (LCG), repeat every cycle */
+
+const uint8_t waveChase[256] = {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0 }; /*!< Chase pulse, on for the first eighth of the cycle */
+
+const uint8_t* const waves[7] = { 0, waveSine, waveTriangle, waveSquare, waveSaw, waveRandom, waveChase }; /*!< Waveforms by number. 0: Off, 1: Sine, 2: Triangle, 3: Square, 4: Saw, 5: Random, 6: Chase */
+
+/*
+ * PWM Dimmer Curves
+ * ========================
+ */
+
+const uint16_t curveLinear[256] = {
+            0,   257,   514,   771,  1028,  1285,  1542,  1799,  2056,  2313,  2570,  2827,
+         3084,  3341,  3598,  3855,  4112,  4369,  4626,  4883,  5140,  5397,  5654,  5911,
+         6168,  6425,  6682,  6939,  7196,  7453,  7710,  7967,  8224,  8481,  8738,  8995,
+         9252,  9509,  9766, 10023, 10280, 10537, 10794, 11051, 11308, 11565, 11822, 12079,
+        12336, 12593, 12850, 13107, 13364, 13621, 13878, 14135, 14392, 14649, 14906, 15163,
+        15420, 15677, 15934, 16191, 16448, 16705, 16962, 17219, 17476, 17733, 17990, 18247,
+        18504, 18761, 19018, 19275, 19532, 19789, 20046, 20303, 20560, 20817, 21074, 21331,
+        21588, 21845, 22102, 22359, 22616, 22873, 23130, 23387, 23644, 23901, 24158, 24415,
+        24672, 24929, 25186, 25443, 25700, 25957, 26214, 26471, 26728, 26985, 27242, 27499,
+        27756, 28013, 28270, 28527, 28784, 29041, 29298, 29555, 29812, 30069, 30326, 30583,
+        30840, 31097, 31354, 31611, 31868, 32125, 32382, 32639, 32896, 33153, 33410, 33667,
+        33924, 34181, 34438, 34695, 34952, 35209, 35466, 35723, 35980, 36237, 36494, 36751,
+        37008, 37265, 37522, 37779, 38036, 38293, 38550, 38807, 39064, 39321, 39578, 39835,
+        40092, 40349, 40606, 40863, 41120, 41377, 41634, 41891, 42148, 42405, 42662, 42919,
+        43176, 43433, 43690, 43947, 44204, 44461, 44718, 44975, 45232, 45489, 45746, 46003,
+        46260, 46517, 46774, 47031, 47288, 47545, 47802, 48059, 48316, 48573, 48830, 49087,
+        49344, 49601, 49858, 50115, 50372, 50629, 50886, 51143, 51400, 51657, 51914, 52171,
+        52428, 52685, 52942, 53199, 53456, 53713, 53970, 54227, 54484, 54741, 54998, 55255,
+        55512, 55769, 56026, 56283, 56540, 56797, 57054, 57311, 57568, 57825, 58082, 58339,
+        58596, 58853, 59110, 59367, 59624, 59881, 60138, 60395, 60652, 60909, 61166, 61423,
+        61680, 61937, 62194, 62451, 62708, 62965, 63222, 63479, 63736, 63993, 64250, 64507,
+        64764, 65021, 65278, 65535 }; /*!< Linear */
+
+const uint16_t curveSquare[256] = {
+            0,     1,     4,     9,    16,    25,    36,    49,    65,    82,   101,   122,
+          145,   170,   198,   227,   258,   291,   327,   364,   403,   444,   488,   533,
+          581,   630,   681,   735,   790,   848,   907,   969,  1032,  1098,  1165,  1235,
+         1306,  1380,  1455,  1533,  1613,  1694,  1778,  1864,  1951,  2041,  2133,  2226,
+         2322,  2420,  2520,  2621,  2725,  2831,  2939,  3049,  3161,  3274,  3390,  3508,
+         3628,  3750,  3874,  4000,  4128,  4258,  4390,  4524,  4660,  4798,  4938,  5081,
+         5225,  5371,  5519,  5669,  5821,  5976,  6132,  6290,  6450,  6612,  6777,  6943,
+         7111,  7282,  7454,  7628,  7805,  7983,  8164,  8346,  8530,  8717,  8905,  9096,
+         9288,  9483,  9679,  9878, 10078, 10281, 10486, 10692, 10901, 11111, 11324, 11539,
+        11755, 11974, 12195, 12418, 12642, 12869, 13098, 13329, 13562, 13796, 14033, 14272,
+        14513, 14756, 15001, 15248, 15497, 15748, 16001, 16256, 16513, 16772, 17033, 17296,
+        17561, 17828, 18097, 18368, 18641, 18916, 19193, 19473, 19754, 20037, 20322, 20609,
+        20899, 21190, 21483, 21778, 22076, 22375, 22676, 22980, 23285, 23593, 23902, 24213,
+        24527, 24842, 25160, 25479, 25801, 26124, 26450, 26777, 27107, 27439, 27772, 28108,
+        28445, 28785, 29127, 29470, 29816, 30164, 30513, 30865, 31219, 31575, 31933, 32292,
+        32654, 33018, 33384, 33752, 34122, 34493, 34867, 35243, 35621, 36001, 36383, 36767,
+        37153, 37541, 37931, 38323, 38717, 39113, 39511, 39912, 40314, 40718, 41124, 41532,
+        41942, 42355, 42769, 43185, 43603, 44024, 44446, 44870, 45297, 45725, 46155, 46588,
+        47022, 47458, 47897, 48337, 48780, 49224, 49671, 50119, 50570, 51022, 51477, 51933,
+        52392, 52852, 53315, 53780, 54246, 54715, 55185, 55658, 56133, 56610, 57088, 57569,
+        58052, 58537, 59023, 59512, 60003, 60496, 60991, 61488, 61986, 62487, 62990, 63495,
+        64002, 64511, 65022, 65535 }; /*!< Square law */
+
+const uint16_t curveGamma[256] = {
+            0,     1,     2,     4,     7,    11,    17,    24,    32,    42,    53,    65,
+           79,    94,   111,   129,   148,   169,   192,   216,   242,   270,   299,   330,
+          362,   396,   432,   469,   508,   549,   591,   635,   681,   729,   779,   830,
+          883,   938,   995,  1053,  1113,  1175,  1239,  1305,  1373,  1443,  1514,  1587,
+         1663,  1740,  1819,  1900,  1983,  2068,  2155,  2243,  2334,  2427,  2521,  2618,
+         2717,  2817,  2920,  3024,  3131,  3240,  3350,  3463,  3578,  3694,  3813,  3934,
+         4057,  4182,  4309,  4438,  4570,  4703,  4838,  4976,  5115,  5257,  5401,  5547,
+         5695,  5845,  5998,  6152,  6309,  6468,  6629,  6792,  6957,  7124,  7294,  7466,
+         7640,  7816,  7994,  8175,  8358,  8543,  8730,  8919,  9111,  9305,  9501,  9699,
+         9900, 10102, 10307, 10515, 10724, 10936, 11150, 11366, 11585, 11806, 12029, 12254,
+        12482, 12712, 12944, 13179, 13416, 13655, 13896, 14140, 14386, 14635, 14885, 15138,
+        15394, 15652, 15912, 16174, 16439, 16706, 16975, 17247, 17521, 17798, 18077, 18358,
+        18642, 18928, 19216, 19507, 19800, 20095, 20393, 20694, 20996, 21301, 21609, 21919,
+        22231, 22546, 22863, 23182, 23504, 23829, 24156, 24485, 24817, 25151, 25487, 25826,
+        26168, 26512, 26858, 27207, 27558, 27912, 28268, 28627, 28988, 29351, 29717, 30086,
+        30457, 30830, 31206, 31585, 31966, 32349, 32735, 33124, 33514, 33908, 34304, 34702,
+        35103, 35507, 35913, 36321, 36732, 37146, 37562, 37981, 38402, 38825, 39252, 39680,
+        40112, 40546, 40982, 41421, 41862, 42306, 42753, 43202, 43654, 44108, 44565, 45025,
+        45487, 45951, 46418, 46888, 47360, 47835, 48313, 48793, 49275, 49761, 50249, 50739,
+        51232, 51728, 52226, 52727, 53230, 53736, 54245, 54756, 55270, 55787, 56306, 56828,
+        57352, 57879, 58409, 58941, 59476, 60014, 60554, 61097, 61642, 62190, 62741, 63295,
+        63851, 64410, 64971, 65535 }; /*!< Gamma 2.2 */
+
+const uint16_t curveS[256] = {
+            0,     3,    12,    27,    48,    75,   107,   145,   189,   239,   294,   355,
+          422,   494,   571,   654,   742,   835,   934,  1037,  1146,  1260,  1379,  1503,
+         1632,  1766,  1905,  2049,  2197,  2350,  2508,  2670,  2837,  3009,  3185,  3365,
+         3550,  3739,  3932,  4130,  4332,  4538,  4748,  4962,  5180,  5402,  5628,  5858,
+         6092,  6330,  6571,  6816,  7064,  7316,  7572,  7831,  8094,  8360,  8629,  8901,
+         9177,  9456,  9739, 10024, 10312, 10604, 10898, 11195, 11495, 11798, 12104, 12412,
+        12724, 13037, 13354, 13673, 13994, 14318, 14644, 14973, 15303, 15637, 15972, 16309,
+        16649, 16991, 17334, 17680, 18027, 18377, 18728, 19081, 19436, 19792, 20150, 20510,
+        20871, 21234, 21598, 21964, 22331, 22699, 23068, 23439, 23811, 24184, 24558, 24933,
+        25309, 25686, 26064, 26442, 26822, 27202, 27583, 27964, 28346, 28729, 29112, 29496,
+        29880, 30264, 30649, 31033, 31419, 31804, 32189, 32575, 32960, 33346, 33731, 34116,
+        34502, 34886, 35271, 35655, 36039, 36423, 36806, 37189, 37571, 37952, 38333, 38713,
+        39093, 39471, 39849, 40226, 40602, 40977, 41351, 41724, 42096, 42467, 42836, 43204,
+        43571, 43937, 44301, 44664, 45025, 45385, 45743, 46099, 46454, 46807, 47158, 47508,
+        47855, 48201, 48544, 48886, 49226, 49563, 49898, 50232, 50562, 50891, 51217, 51541,
+        51862, 52181, 52498, 52811, 53123, 53431, 53737, 54040, 54340, 54637, 54931, 55223,
+        55511, 55796, 56079, 56358, 56634, 56906, 57175, 57441, 57704, 57963, 58219, 58471,
+        58719, 58964, 59205, 59443, 59677, 59907, 60133, 60355, 60573, 60787, 60997, 61203,
+        61405, 61603, 61796, 61985, 62170, 62350, 62526, 62698, 62865, 63027, 63185, 63338,
+        63486, 63630, 63769, 63903, 64032, 64156, 64275, 64389, 64498, 64601, 64700, 64793,
+        64881, 64964, 65041, 65113, 65180, 65241, 65296, 65346, 65390, 65428, 65460, 65487,
+        65508, 65523, 65532, 65535 }; /*!< S-curve, slow at both ends */
+
+const uint16_t* const curves[4] = { curveLinear, curveSquare, curveGamma, curveS }; /*!< Dimmer curves by number, Q16 output for each DMX level. 0: Linear, 1: Square law, 2: Gamma 2.2, 3: S-curve */
+uint8_t outputCurve[3] = { 0, 0, 0 }; /*!< Dimmer curve of the red, green and blue outputs. */
+uint16_t outputCompare[3][256]; /*!< PWM compare value for each DMX level of the red, green and blue outputs, built from the curve and period. */
+uint8_t personality = 0; /*!< Slots read by the PWM outputs. 0: 8-bit, red, green, blue. 1: 16-bit, coarse and fine pairs for red, green, blue */
+uint16_t pwmPeriod[2] = { PWM_PERIOD, PWM_PERIOD }; /*!< Load value of PWM1 generator 2 (red, servo) and generator 3 (green, blue), in PWM clocks. */
+
+/*
+ * Console Frame CRC
+ * ========================
+ */
+
+const uint16_t crcTable[256] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+        0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+        0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+        0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+        0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+        0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+        0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+        0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+        0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+        0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+        0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+        0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+        0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+        0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+        0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+        0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+        0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+        0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+        0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+        0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+        0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+        0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+        0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+        0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+        0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+        0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+        0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+        0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+        0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+        0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+        0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0 }; /*!< CRC-16/CCITT, polynomial 0x1021, by top byte of the running CRC */
+
 /*
  * Launchpad Control Global Variables
  * ========================
  */
 uint8_t mode = 0; /*!< Indicates the current mode of the launchpad. 0: Device, 1: Controller. */
-uint8_t dmxData[512]; /*!< Array to store bins of DMX data. */
+dmxPort ports[DMX_PORTS]; /*!< DMX outputs, one universe each. Port 0 is UART1. */
+const uint32_t portBase[DMX_PORTS] = { 0x4000D000, 0x4000E000, 0x4000F000,
+                                       0x40011000, 0x40012000, 0x40013000 }; /*!< UART1, 2, 3, 5, 6, 7 base addresses */
 uint8_t RGBMode = 0; /*!< Flag to indicate whether in 1: full device mode or 0: normal device mode. (Full device mode: Onboard R,G,B LED has address 1,2,3 wrt device Address)
  normal device mode: device will function according to specifications.*/
 
@@ -155,11 +814,11 @@ uint8_t RGBMode = 0; /*!< Flag to indicate whether in 1: full device mode or 0:
  * Function Definitions
  * ========================
  */
-void animationRamp();
 void clearStr();
 char getcUart0();
 void getModeEE();
 char* intToChar(uint16_t x);
+char* longToChar(uint32_t x);
 bool isLetter(char c);
 bool isNumber(char c);
 uint8_t main(void);
@@ -169,7 +828,76 @@ void Uart0Isr(void);
 void waitMicrosecond(uint32_t us);
 void wooone();
 void putsUart0(char*);
+void putcUart0(char);
+void drainUart0();
+void serviceConsole();
+void consoleChar(char);
+void printConsoleStats();
+uint16_t crc16(uint16_t, uint8_t);
+void frameByte(uint8_t);
+void frameDone();
+void frameReply(uint8_t, uint16_t, const uint8_t*, uint16_t);
+void setBaudUart0(uint32_t);
+void enttecByte(uint8_t);
+void enttecDone();
+void enttecAbort();
+void enttecPacket(uint8_t, const uint8_t*, uint8_t, const uint8_t*, uint16_t);
+void enttecReceived();
+uint8_t hashCommand(const char*);
+void buildCommandHash();
+uint8_t findCommand(const char*);
+void fillSlots(uint8_t*, uint16_t, uint8_t);
+void stopFades(uint8_t, uint16_t, uint16_t);
 void changeTimer1Value(uint32_t);
+void startTxDma(uint8_t*, uint16_t);
+void startRxDma();
+void configRxUart();
+void rxDmaIsr();
+void rxByte(uint16_t);
+void rxCommit(uint16_t);
+void rxBegin();
+void rxAbort();
+void countBreak();
+void armCapture();
+void repeatForward();
+void stopRepeater();
+void changeTimer3Value(uint32_t);
+void startFade(uint16_t, uint16_t, uint16_t, uint32_t);
+void fadeStep10ms();
+bool fading();
+void triggerEffects();
+void stepGenerators();
+void stepCues();
+void flashErase(uint32_t);
+void flashWrite(uint32_t, const uint32_t*, uint16_t);
+void recordScene(uint8_t, const uint8_t*);
+void saveCues();
+void holdOutput();
+void releaseOutput();
+void loadByte(uint8_t);
+void loadRecordDone();
+void loadFail();
+void buildCurve(uint8_t);
+void configPwm();
+uint16_t compare16(uint8_t, const uint8_t*);
+bool generating();
+void mergeRxByte(uint16_t);
+void mergeCommit(uint16_t);
+void mergeUniverses(uint8_t);
+void startMergeFrame();
+void configMergeUart();
+void fillPortFifo(uint8_t);
+void endPortFrame(uint8_t);
+void portIsr(uint8_t);
+uint16_t parseAddress(char*, uint8_t*);
+void configTxUart();
+void startBreak();
+uint32_t frameGap();
+uint16_t highestSlot(uint8_t*);
+void beginDMXWrite(uint8_t);
+void endDMXWrite(uint8_t);
+void abortDMXWrite(uint8_t);
+void swapDMX(uint8_t);
 
 /*
  * Subroutines
@@ -184,6 +912,8 @@ void changeTimer1Value(uint32_t);
 void initHw()
 {
 
+    uint8_t i;
+
     /**
      *    Configure HW to work with 16 MHz XTAL, PLL enabled, system clock of 40 MHz
      */
@@ -197,10 +927,10 @@ void initHw()
     SYSCTL_GPIOHBCTL_R = 0;
 
     /**
-     *   Enable GPIO port A for UART0, port C for UART1 and port F peripherals, and PORTD for DIP Switch
+     *   Enable GPIO port A for UART0, port C for UART1 and port F peripherals, PORTD for DIP Switch and PORTC, D, E for UART2-7
      */
     SYSCTL_RCGC2_R = SYSCTL_RCGC2_GPIOA | SYSCTL_RCGC2_GPIOC
-            | SYSCTL_RCGC2_GPIOF | SYSCTL_RCGC2_GPIOD;
+            | SYSCTL_RCGC2_GPIOF | SYSCTL_RCGC2_GPIOD | SYSCTL_RCGC2_GPIOE;
 
     /**
      *  Give clock to EEPROM
@@ -246,11 +976,41 @@ void initHw()
     GPIO_PORTC_AFSEL_R |= 0x30;
     GPIO_PORTC_PCTL_R |= GPIO_PCTL_PC5_U1TX | GPIO_PCTL_PC4_U1RX;
 
+    /**
+     *  Configure PC7, PD5, PD7, PE1, PE5 for UART3, 6, 2, 7, 5 Transmit. PD7 is locked by default for NMI.
+     */
+    GPIO_PORTD_LOCK_R = GPIO_LOCK_KEY;
+    GPIO_PORTD_CR_R |= 0x80;
+    GPIO_PORTC_DIR_R |= 0x80;
+    GPIO_PORTC_DEN_R |= 0x80;
+    GPIO_PORTC_AFSEL_R |= 0x80;
+    GPIO_PORTC_PCTL_R |= GPIO_PCTL_PC7_U3TX;
+    GPIO_PORTD_DIR_R |= 0xA0;
+    GPIO_PORTD_DEN_R |= 0xA0;
+    GPIO_PORTD_AFSEL_R |= 0xA0;
+    GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD7_U2TX | GPIO_PCTL_PD5_U6TX;
+    GPIO_PORTE_DIR_R |= 0x22;
+    GPIO_PORTE_DEN_R |= 0x22;
+    GPIO_PORTE_AFSEL_R |= 0x22;
+    GPIO_PORTE_PCTL_R |= GPIO_PCTL_PE5_U5TX | GPIO_PCTL_PE1_U7TX;
+
+    /**
+     *  Configure PD6 for Wide Timer 5 capture, pulled up so the line reads idle without the jumper
+     */
+    GPIO_PORTD_DIR_R &= ~0x40;
+    GPIO_PORTD_DEN_R |= 0x40;
+    GPIO_PORTD_PUR_R |= 0x40;
+    GPIO_PORTD_AFSEL_R |= 0x40;
+    GPIO_PORTD_PCTL_R |= GPIO_PCTL_PD6_WT5CCP0;
+
     /**
      *  Give clock to UART0, UART1, TIMER1, TIMER2
      */
     SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R1 | SYSCTL_RCGCUART_R0; // turn-on UART0,1 , leave other UARTs in same status
-    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R2;
+    SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R2 | SYSCTL_RCGCUART_R3
+            | SYSCTL_RCGCUART_R5 | SYSCTL_RCGCUART_R6 | SYSCTL_RCGCUART_R7; // turn-on UART2,3,5,6,7 for the other universes
+    SYSCTL_RCGCTIMER_R |= SYSCTL_RCGCTIMER_R0 | SYSCTL_RCGCTIMER_R1 | SYSCTL_RCGCTIMER_R2 | SYSCTL_RCGCTIMER_R3;
+    SYSCTL_RCGCWTIMER_R |= SYSCTL_RCGCWTIMER_R5;
 
     delay4Cycles();
     // wait 4 clock cycles
@@ -262,7 +1022,8 @@ void initHw()
     UART0_CC_R = UART_CC_CS_SYSCLK;                 // use system clock (40 MHz)
     UART0_IBRD_R = 21; // r = 40 MHz / (Nx115.2kHz), set floor(r)=21, where N=16
     UART0_FBRD_R = 45;                               // round(fract(r)*64)=45
-    UART0_LCRH_R = UART_LCRH_WLEN_8; // configure for 8N1 w/ 16-level FIFO
+    UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN; // configure for 8N1 w/ 16-level FIFO
+    UART0_IFLS_R = UART_IFLS_TX4_8 | UART_IFLS_RX4_8; // interrupt at half full RX FIFO, half empty TX FIFO
     UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN; // enable TX, RX, and module
 
     /**
@@ -275,12 +1036,52 @@ void initHw()
     UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2;
     UART1_CTL_R = UART_CTL_TXE | UART_CTL_UARTEN | UART_CTL_EOT;
 
-    UART0_IM_R = UART_IM_RXIM;                       // turn-on RX interrupt
+    UART0_IM_R = UART_IM_RXIM | UART_IM_RTIM;        // turn-on RX and RX timeout interrupts
+    NVIC_PRI1_R = (NVIC_PRI1_R & ~NVIC_PRI1_INTB_M) | (2 << NVIC_PRI1_INTB_S); // priority 2 for interrupt 21 (UART0), below DMX
     NVIC_EN0_R |= 1 << (INT_UART0 - 16);         // turn-on interrupt 21 (UART0)
 
     UART1_IM_R = UART_IM_RXIM | UART_IM_TXIM;
     NVIC_EN0_R |= 1 << (INT_UART1 - 16);
 
+    /**
+     * Configuring universes and UART2, 3, 5, 6, 7 for 250 kbaud 8N2 with the TX FIFO refilled at 2 entries left
+     */
+    for (i = 0; i < DMX_PORTS; ++i)
+    {
+        ports[i].base = portBase[i];
+        ports[i].back = (uint8_t*) &ports[i].buffer[0][1];
+        ports[i].front = (uint8_t*) &ports[i].buffer[1][1];
+        ports[i].maxSlots = 512;
+        ports[i].enabled = (i == 0);
+        if (i > 0)
+        {
+            UART_REG(ports[i].base, UART_O_CTL) = 0;
+            UART_REG(ports[i].base, UART_O_CC) = UART_CC_CS_SYSCLK;
+            UART_REG(ports[i].base, UART_O_IBRD) = 10;
+            UART_REG(ports[i].base, UART_O_FBRD) = 0;
+            UART_REG(ports[i].base, UART_O_LCRH) = UART_LCRH_WLEN_8 | UART_LCRH_STP2 | UART_LCRH_FEN;
+            UART_REG(ports[i].base, UART_O_IFLS) = UART_IFLS_TX1_8;
+            UART_REG(ports[i].base, UART_O_CTL) = UART_CTL_TXE | UART_CTL_UARTEN;
+            UART_REG(ports[i].base, UART_O_IM) = UART_IM_TXIM;
+        }
+    }
+    NVIC_EN1_R |= 1 << (INT_UART2 - 16 - 32) | 1 << (INT_UART3 - 16 - 32)
+            | 1 << (INT_UART5 - 16 - 32) | 1 << (INT_UART6 - 16 - 32)
+            | 1 << (INT_UART7 - 16 - 32);
+
+    /**
+     * Configuring uDMA for UART1 transmit. Completion of the channel is signaled on the UART1 interrupt.
+     */
+    SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0;
+    delay4Cycles();
+    UDMA_CFG_R = UDMA_CFG_MASTEN;                    // enable uDMA controller
+    UDMA_CTLBASE_R = (uint32_t) udmaControlTable;    // location of channel control table
+    UDMA_CHMAP2_R &= ~(UDMA_CHMAP2_CH23SEL_M | UDMA_CHMAP2_CH22SEL_M); // channel 23/22 encoding 0 is UART1 TX/RX
+    UDMA_PRIOCLR_R = 1 << UDMA_CH_UART1TX | 1 << UDMA_CH_UART1RX;           // default priority
+    UDMA_ALTCLR_R = 1 << UDMA_CH_UART1TX | 1 << UDMA_CH_UART1RX;            // use primary control structure
+    UDMA_USEBURSTCLR_R = 1 << UDMA_CH_UART1TX | 1 << UDMA_CH_UART1RX;       // respond to single and burst requests
+    UDMA_REQMASKCLR_R = 1 << UDMA_CH_UART1TX | 1 << UDMA_CH_UART1RX;        // allow requests from UART1
+
     /**
      * Configuring Timer 1 for DMX Transmit and Receive
      */
@@ -293,16 +1094,43 @@ void initHw()
     TIMER1_CTL_R |= TIMER_CTL_TAEN;                  // turn-on timer
 
     /**
-     * Configuring Timer 2 for DMX Transmit and Receive
+     * Configuring Timer 0 as free running timestamp for frame timing measurements
      */
-    TIMER2_CTL_R &= ~TIMER_CTL_TAEN;      // turn-off timer before reconfiguring
-    TIMER2_CFG_R = TIMER_CFG_32_BIT_TIMER;    // configure as 32-bit timer (A+B)
-    TIMER2_TAMR_R = TIMER_TAMR_TAMR_PERIOD; // configure for periodic mode (count down)
-    TIMER2_TAILR_R = 3000000; //10000000; // set load value to 2e5 for 200 Hz interrupt rate
+    TIMER0_CTL_R &= ~TIMER_CTL_TAEN;      // turn-off timer before reconfiguring
+    TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;    // configure as 32-bit timer (A+B)
+    TIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD | TIMER_TAMR_TACDIR; // configure for periodic mode (count up)
+    TIMER0_TAILR_R = 0xFFFFFFFF;          // wraps every 107 seconds at 40 MHz
+    TIMER0_CTL_R |= TIMER_CTL_TAEN;                  // turn-on timer, no interrupts
 
-    TIMER2_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts
+    /**
+     * Configuring Timer 3 as one shot for the repeater break and mark after break
+     */
+    TIMER3_CTL_R &= ~TIMER_CTL_TAEN;      // turn-off timer before reconfiguring
+    TIMER3_CFG_R = TIMER_CFG_32_BIT_TIMER;    // configure as 32-bit timer (A+B)
+    TIMER3_TAMR_R = TIMER_TAMR_TAMR_1_SHOT; // configure for one shot mode (count down)
+    TIMER3_IMR_R = TIMER_IMR_TATOIM;                 // turn-on interrupts
+    NVIC_EN1_R |= 1 << (INT_TIMER3A - 16 - 32);     // turn-on interrupt 51 (TIMER3A)
+
+    /**
+     * Configuring Wide Timer 5A to timestamp both edges of the DMX receive line.
+     * Interrupts are only enabled from the break to the start code.
+     */
+    WTIMER5_CTL_R &= ~TIMER_CTL_TAEN;     // turn-off timer before reconfiguring
+    WTIMER5_CFG_R = TIMER_CFG_16_BIT;     // configure as 32-bit timer (A only)
+    WTIMER5_TAMR_R = TIMER_TAMR_TAMR_CAP | TIMER_TAMR_TACMR | TIMER_TAMR_TACDIR; // edge time capture (count up)
+    WTIMER5_CTL_R = TIMER_CTL_TAEVENT_BOTH; // capture rising and falling edges
+    WTIMER5_TAILR_R = 0xFFFFFFFF;         // wraps every 107 seconds at 40 MHz
+    WTIMER5_IMR_R = 0;
+    NVIC_EN3_R |= 1 << (INT_WTIMER5A - 16 - 96); // turn-on interrupt 120 (WTIMER5A)
+    WTIMER5_CTL_R |= TIMER_CTL_TAEN;      // turn-on timer
+
+    /**
+     * Timer 2 interrupt computes the effects of the next frame. It is triggered in software at each break,
+     * below the priority of the DMX interrupts so it never delays the break or mark after break.
+     */
+    TIMER2_IMR_R = 0;
+    NVIC_PRI5_R = (NVIC_PRI5_R & ~NVIC_PRI5_INTD_M) | (3 << NVIC_PRI5_INTD_S); // priority 3 for interrupt 39 (TIMER2A)
     NVIC_EN0_R |= 1 << (INT_TIMER2A - 16);     // turn-on interrupt 39 (TIMER2A)
-    TIMER2_CTL_R |= TIMER_CTL_TAEN;                  // turn-on timer
 
     /**
      * EEPROM initialize and configuration from datasheet
@@ -354,8 +1182,8 @@ void initHw()
     PWM1_3_GENA_R = PWM_1_GENA_ACTCMPAD_ZERO | PWM_1_GENA_ACTLOAD_ONE; // output 4 on PWM0, gen 2a, cmpa
     PWM1_3_GENB_R = PWM_1_GENB_ACTCMPBD_ZERO | PWM_1_GENB_ACTLOAD_ONE; // output 5 on PWM0, gen 2b, cmpb
 
-    PWM1_2_LOAD_R = 50000; // set period to 40 MHz sys clock / 16 / 50000 = 50Hz for servo control
-    PWM1_3_LOAD_R = 50000; // set period to 40 MHz sys clock / 16 / 50000 = 50Hz for servo control
+    PWM1_2_LOAD_R = pwmPeriod[0]; // set period to 40 MHz sys clock / 16 / 50000 = 50Hz for servo control
+    PWM1_3_LOAD_R = pwmPeriod[1]; // set period to 40 MHz sys clock / 16 / 50000 = 50Hz for servo control
     PWM1_INVERT_R =
     PWM_INVERT_PWM5INV | PWM_INVERT_PWM6INV | PWM_INVERT_PWM7INV; // invert outputs so duty cycle increases with increasing compare values
     PWM1_2_CMPB_R = 0;               // red off (0=always low, 1023=always high)
@@ -366,6 +1194,16 @@ void initHw()
     PWM1_3_CTL_R = PWM_3_CTL_ENABLE;                 // turn-on PWM0 generator 2
     PWM1_ENABLE_R = PWM_ENABLE_PWM5EN | PWM_ENABLE_PWM6EN | PWM_ENABLE_PWM7EN;
 
+    /**
+     * Load the cue list from flash
+     */
+    memcpy(cues, (const void*) CUE_BASE, sizeof(cues));
+
+    /**
+     * Index the console commands
+     */
+    buildCommandHash();
+
 }
 
 /**
@@ -379,755 +1217,4017 @@ void Uart1Isr()
     //For controller mode
     if (mode == 1)
     {
-        if (DMXMode - 3 < maxAddress)
+        txIsrCount++;
+        if (DMXMode < 3 || !(portsBusy & 1))
+        {
+            //nothing to send during break and mark after break, or while the other universes finish
+            UART1_ICR_R = UART_ICR_TXIC;
+        }
+        else if (UDMA_CHIS_R & (1 << UDMA_CH_UART1TX))
+        {
+            //uDMA has moved the last slot into the FIFO, end of transmission interrupt follows
+            UDMA_CHIS_R = 1 << UDMA_CH_UART1TX;
+        }
+        else if (txMode == 2 && ports[0].next < ports[0].slots)
         {
-            UART1_DR_R = dmxData[DMXMode - 3];
-            DMXMode++;
+            UART1_ICR_R = UART_ICR_TXIC;
+            fillPortFifo(0);
+        }
+        else if (ports[0].next < ports[0].slots)
+        {
+            UART1_DR_R = dmxFront[ports[0].next++];
             UART1_ICR_R = UART_ICR_TXIC;
         }
         else
         {
             UART1_ICR_R = UART_ICR_TXIC;
-            GPIO_PORTC_AFSEL_R &= 0x00;
-            GPIO_PORTC_DATA_R &= 0xDF;
-            DMXMode = 0;
-            UART1_CTL_R = 0;
-            changeTimer1Value(176);
-            TIMER1_CTL_R |= TIMER_CTL_TAEN;
+            UDMA_ENACLR_R = 1 << UDMA_CH_UART1TX;
 
+            txIsrPerFrame = txIsrCount;
+            txIsrCount = 0;
+            txFrames++;
+            endPortFrame(0);
         }
     }
 
     //For device mode
-    if (UART1_MIS_R & UART_MIS_RXMIS)
+    if (mode == 0 && rxMode == 1)
     {
+        rxDmaIsr();
+        return;
+    }
+    if (mode == 0
+            && (UART1_MIS_R
+                    & (UART_MIS_RXMIS | UART_MIS_RTMIS | UART_MIS_OEMIS
+                            | UART_MIS_BEMIS)))
+    {
+        rxIsrCount++;
+        UART1_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC | UART_ICR_OEIC
+                | UART_ICR_BEIC;
 
-        uint16_t U1_DR = UART1_DR_R;
-        uint8_t data = U1_DR & 0xFF;
-
-        //enable error Timer if rxState is 0; blinks green LED after 2 seconds if no activity.
-        if (rxState == 0)
+        //slots were lost after the ones in the FIFO, skip the rest of the frame until the next break
+        if (UART1_RSR_R & UART_RSR_OE)
         {
-            TIMER1_CTL_R |= TIMER_CTL_TAEN;
+            UART1_ECR_R = 0;
+            rxStats.overruns++;
+            if (rxState >= 2)
+            {
+                rxStats.dropped++;
+                rxAbort();
+            }
+            rxState = 0;
         }
 
-        //if you get break bit
-        if (U1_DR & 0x400)
+        //drain the FIFO, the receive timeout interrupt picks up the tail of the frame
+        while (!(UART1_FR_R & UART_FR_RXFE))
         {
-            changeTimer1Value(2000000);
-            TIMER1_CTL_R |= TIMER_CTL_TAEN;
-            rxState = 1;
-            rxError = 0;
-            prevRX = 0;
-            GREEN_LED = 1;
+            rxByte(UART1_DR_R);
         }
-
-        //ignore mark after break
-        //get start bit
-        else if (rxState == 1 && data == 0)
+        if (repeat)
         {
-            prevRX = 1;
-            rxState = 2;
-
+            repeatForward();
         }
+    }
+
+}
+
+/**
+ * @brief
+ *
+ * Function to run the receive state machine for one character read from UART1
+ */
+void rxByte(uint16_t U1_DR /**< [in] UART1 data register value with error flags */)
+{
+
+    uint8_t data = U1_DR & 0xFF;
 
-        //get dmx data
-        else if (rxState >= 2 && rxState <= 514)
+    //enable error Timer if rxState is 0; blinks green LED after 2 seconds if no activity.
+    if (rxState == 0)
+    {
+        TIMER1_CTL_R |= TIMER_CTL_TAEN;
+    }
+
+    //if you get break bit, it also ends a frame shorter than 512 slots
+    if (U1_DR & UART_DR_BE)
+    {
+        if (rxState >= 2)
+        {
+            rxCommit(rxState - 2);
+        }
+        countBreak();
+        armCapture();
+        if (repeat)
         {
-            dmxData[(rxState) - 2] = data;
-            prevRX = rxState;
-            rxState++;
+            //outputs follow this frame from the universe it is received into
+            repSource = dmxData;
+            repAvailable = 0;
+            repState = 0;
+            changeTimer3Value(1);
+        }
+        changeTimer1Value(2000000);
+        TIMER1_CTL_R |= TIMER_CTL_TAEN;
+        rxState = 1;
+        rxError = 0;
+        prevRX = 0;
+        GREEN_LED = 1;
+    }
 
-            if (rxState == 514)
-            {
-                GREEN_LED ^= 1;
-                rxState = 0;
-            }
+    //framing error, wait for the next break
+    else if (U1_DR & UART_DR_FE)
+    {
+        rxStats.framingErrors++;
+        if (rxState >= 2)
+        {
+            rxStats.dropped++;
+            rxAbort();
         }
+        rxState = 0;
+    }
 
-        //turn on error state if no data
-        else
+    //ignore mark after break
+    //get start bit
+    else if (rxState == 1 && data == 0)
+    {
+        rxBegin();
+        dmxData[-1] = data;
+        prevRX = 1;
+        rxState = 2;
+        repAvailable = 1;
+        repInStart = TIMESTAMP;
+
+    }
+
+    //alternate start code, not dimmer data
+    else if (rxState == 1)
+    {
+        rxStats.startCodes++;
+        rxState = 0;
+    }
+
+    //get dmx data
+    else if (rxState >= 2 && rxState <= 514)
+    {
+        dmxData[(rxState) - 2] = data;
+        prevRX = rxState;
+        rxState++;
+        repAvailable = rxState - 1;
+
+        //complete frame received, no need to wait for the break
+        if (rxState == 514)
         {
+            rxCommit(512);
             rxState = 0;
         }
-
     }
-    UART1_ICR_R = 0;
 
+    //turn on error state if no data
+    else
+    {
+        rxState = 0;
+    }
 }
 
 /**
  * @brief
  *
- * Function to send characters to UART0
+ * Function to make a received frame of 24 to 512 slots visible to the outputs. Shorter frames are dropped.
  */
-void putcUart1(uint8_t i /**< [in] character to send to UART1 */)
+void rxCommit(uint16_t slots /**< [in] number of DMX Bins received */)
 {
 
-    while (UART1_FR_R & UART_FR_TXFF);               // wait if uart0 tx fifo full
-    UART1_DR_R = i;                                  // write character to fifo
+    uint32_t now = TIMESTAMP;
+
+    if (slots < 24)
+    {
+        rxStats.dropped++;
+        rxAbort();
+        return;
+    }
+
+    //bins the controller does not send read as 0
+    if (slots < 512)
+    {
+        memset(dmxData + slots, 0, 512 - slots);
+    }
+    endDMXWrite(0);
+    rxWriting = 0;
+    swapDMX(0);
+    triggerEffects();
+    GREEN_LED ^= 1;
+    rxIsrPerFrame = rxIsrCount;
+    rxIsrCount = 0;
+
+    rxStats.frames++;
+    rxStats.slots = slots;
+    rxStats.histogram[(slots - 1) >> 6]++;
+    rxStats.lastGood = now;
+    if (merge)
+    {
+        mergeUniverses(0);
+    }
+    rxStats.windowFrames++;
+    if (now - rxStats.windowStart >= 40000000)
+    {
+        rxStats.fps = rxStats.windowFrames;
+        rxStats.windowFrames = 0;
+        rxStats.windowStart = now;
+    }
 }
 
 /**
  * @brief
  *
- * Function to change load value of Timer1
+ * Function to take the back universe for a frame about to be received. Called at the start code, or when the
+ * uDMA transfer is pointed at the back universe.
  */
-void changeTimer1Value(uint32_t us /**< [in] time in microseconds to convert to load value */)
+void rxBegin()
 {
 
-    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
-    TIMER1_TAILR_R = us * 40;             // turn-off timer before reconfiguring
-    // reset interrupt
-    // set load value to 2e5 for 200 Hz interrupt rate
-    TIMER1_CTL_R |= TIMER_CTL_TAEN;
+    if (!rxWriting)
+    {
+        beginDMXWrite(0);
+        rxWriting = 1;
+    }
 }
 
 /**
  * @brief
  *
- * Function to Handle Interrupts from Timer2
+ * Function to give up the frame being received. The slots already written are dropped, not published.
  */
-void Timer2ISR()
+void rxAbort()
 {
 
-    if (woo == 2)
+    if (rxWriting)
     {
-        if (dmxData[deviceModeAddress - 1] == 0)
-        {
-            upR = 1;
-            dmxData[deviceModeAddress - 1] = 2;
-            goR = 0;
-            goG = 1;
-            goB = 0;
-        }
-        if (dmxData[deviceModeAddress - 1] == 254)
-        {
-            upR = 0;
-            dmxData[deviceModeAddress - 1] = 252;
-            goR = 0;
-            goG = 1;
-            goB = 0;
-
-        }
-
-        if (dmxData[deviceModeAddress + 1 - 1] == 0)
-        {
-            upG = 1;
-            dmxData[deviceModeAddress + 1 - 1] = 2;
-            goR = 0;
-            goG = 0;
-            goB = 1;
-        }
-        if (dmxData[deviceModeAddress + 1 - 1] == 254)
-        {
-            upG = 0;
-            dmxData[deviceModeAddress + 1 - 1] = 252;
-            goR = 0;
-            goG = 0;
-            goB = 1;
-        }
+        abortDMXWrite(0);
+        rxWriting = 0;
+    }
+}
 
-        if (dmxData[deviceModeAddress + 2 - 1] == 0)
-        {
-            upB = 1;
-            dmxData[deviceModeAddress + 2 - 1] = 2;
-            goR = 1;
-            goG = 0;
-            goB = 0;
-        }
-        if (dmxData[deviceModeAddress + 2 - 1] == 254)
-        {
-            upB = 0;
-            dmxData[deviceModeAddress + 2 - 1] = 252;
-            goR = 1;
-            goG = 0;
-            goB = 0;
-        }
+/**
+ * @brief
+ *
+ * Function to start timing the break and mark after break. Called at the break error while the line is still low,
+ * so the last captured edge is the falling edge that started the break.
+ */
+void armCapture()
+{
 
-        if (goR)
-        {
+    WTIMER5_ICR_R = TIMER_ICR_CAECINT;
+    if (GPIO_PORTD_DATA_R & 0x40)
+    {
+        //line is already in the mark after break (or PD6 is not jumpered), skip this frame
+        capState = 0;
+        capBreakValid = 0;
+        WTIMER5_IMR_R = 0;
+        return;
+    }
+    if (capBreakValid)
+    {
+        rxStats.period = WTIMER5_TAR_R - capBreakStart;
+    }
+    capBreakStart = WTIMER5_TAR_R;
+    capBreakValid = 1;
+    capState = 1;
+    WTIMER5_IMR_R = TIMER_IMR_CAEIM;
+}
 
-            if (upR)
-                dmxData[deviceModeAddress - 1] = (2
-                        + dmxData[deviceModeAddress - 1]) % 256;
-            else
-                dmxData[deviceModeAddress - 1] = (dmxData[deviceModeAddress - 1]
-                        - 2) % 256;
-        }
-        if (goG)
-        {
-            if (upG)
-                dmxData[deviceModeAddress + 1 - 1] = (2
-                        + dmxData[deviceModeAddress + 1 - 1]) % 256;
-            else
-                dmxData[deviceModeAddress + 1 - 1] = (dmxData[deviceModeAddress
-                        + 1 - 1] - 2) % 256;
-        }
-        if (goB)
-        {
-            if (upB)
-                dmxData[deviceModeAddress + 2 - 1] = (2
-                        + dmxData[deviceModeAddress + 2 - 1]) % 256;
-            else
-                dmxData[deviceModeAddress + 2 - 1] = (dmxData[deviceModeAddress
-                        + 2 - 1] - 2) % 256;
-        }
+/**
+ * @brief
+ *
+ * Function to Handle Wide Timer 5A edge capture. Measures the break and mark after break and
+ * ignores the frame if either is out of spec (break < 88 us, mark after break < 8 us).
+ */
+void WideTimer5ISR()
+{
 
-    }
+    uint32_t stamp = WTIMER5_TAR_R;
 
-    if (woo == 4)
+    WTIMER5_ICR_R = TIMER_ICR_CAECINT;
+    if (capState == 1)
     {
-        if (servoDir == 0)
-        {
-            dmxData[deviceModeAddress + 0 - 1]--;
-        }
-        else
-        {
-            dmxData[deviceModeAddress + 0 - 1]++;
-        }
-
+        //rising edge, end of break
+        rxStats.breakTicks = stamp - capBreakStart;
+        capMabStart = stamp;
+        capState = 2;
     }
-
-    if (woo == 5)
+    else if (capState == 2)
     {
-        seconds += 0.1;
-        dimValue -= (dimStart - dimEnd) / secondsTrigger / 10;
-        dmxData[deviceModeAddress - 1] = dimValue;
-        if (dimStart - dimEnd > 0)
-        {
-            if (dimValue < dimEnd)
-            {
-                putsUart0("Done Ramp\n\r");
-                dmxData[deviceModeAddress - 1] = dimEnd;
-                woo = 0;
-            }
-        }
-        if (dimStart - dimEnd < 0)
+        //falling edge, start bit of the start code
+        rxStats.mabTicks = stamp - capMabStart;
+        WTIMER5_IMR_R = 0;
+        capState = 0;
+        if (rxStats.breakTicks < 88 * 40 || rxStats.mabTicks < 8 * 40)
         {
-            if (dimValue > dimEnd)
+            rxStats.badBreaks++;
+            rxState = 0;
+            rxDmaValid = 0;
+            if (rxMode == 0)
             {
-                putsUart0("Done Ramp\n\r");
-                dmxData[deviceModeAddress - 1] = dimEnd;
-                woo = 0;
+                //the uDMA engine keeps the universe until the transfer stops at the next break
+                rxAbort();
             }
         }
     }
-
-    TIMER2_ICR_R = TIMER_ICR_TATOCINT;
+    else
+    {
+        WTIMER5_IMR_R = 0;
+    }
 }
 
 /**
  * @brief
  *
- * Function to handle TIMER1 interrupts
+ * Function to count a received break and measure the break to break period
  */
-void Timer1ISR()
+void countBreak()
 {
 
-    if (mode == 3 && GREEN_LED == 0)
+    uint32_t now = TIMESTAMP;
+
+    //approximate period, replaced by the captured one when PD6 is jumpered
+    rxStats.breaks++;
+    if (rxBreakValid)
     {
-        GREEN_LED ^= 1;
-        changeTimer1Value(15000);
+        rxStats.period = now - rxStats.lastBreak;
+    }
+    rxStats.lastBreak = now;
+    rxBreakValid = 1;
+}
+
+/**
+ * @brief
+ *
+ * Function to send characters to UART0
+ */
+void putcUart1(uint8_t i /**< [in] character to send to UART1 */)
+{
+
+    while (UART1_FR_R & UART_FR_TXFF);               // wait if uart0 tx fifo full
+    UART1_DR_R = i;                                  // write character to fifo
+}
+
+/**
+ * @brief
+ *
+ * Function to hand DMX slots to the uDMA controller for transmission on UART1
+ */
+void startTxDma(uint8_t* src /**< [in] first slot to transmit */, uint16_t count /**< [in] number of slots to transmit */)
+{
+
+    uint32_t* control = &udmaControlTable[UDMA_CH_UART1TX * 4];
 
+    if (count == 0)
+    {
+        return;
     }
-    if (mode == 3 && GREEN_LED == 1)
+    control[0] = (uint32_t) (src + count - 1);       // source end pointer
+    control[1] = (uint32_t) &UART1_DR_R;             // destination end pointer
+    control[2] = UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8
+            | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_ARBSIZE_4
+            | ((count - 1) << UDMA_CHCTL_XFERSIZE_S) | UDMA_CHCTL_XFERMODE_BASIC;
+    UDMA_ENASET_R = 1 << UDMA_CH_UART1TX;
+}
+
+/**
+ * @brief
+ *
+ * Function to hand the back universe to the uDMA controller to receive the start code and 512 slots from UART1
+ */
+void startRxDma()
+{
+
+    uint32_t* control = &udmaControlTable[UDMA_CH_UART1RX * 4];
+
+    control[0] = (uint32_t) &UART1_DR_R;             // source end pointer
+    control[1] = (uint32_t) (dmxData + 511);         // destination end pointer, start code lands at dmxData[-1]
+    control[2] = UDMA_CHCTL_DSTINC_8 | UDMA_CHCTL_DSTSIZE_8
+            | UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_SRCSIZE_8 | UDMA_CHCTL_ARBSIZE_1
+            | (512 << UDMA_CHCTL_XFERSIZE_S) | UDMA_CHCTL_XFERMODE_BASIC;
+    UDMA_ENASET_R = 1 << UDMA_CH_UART1RX;
+}
+
+/**
+ * @brief
+ *
+ * Function to configure UART1 for the selected receive engine.
+ */
+void configRxUart()
+{
+
+    UART1_CTL_R = 0;
+    UART1_DMACTL_R = 0;
+    UDMA_ENACLR_R = 1 << UDMA_CH_UART1RX;
+    rxAbort();
+    GPIO_PORTC_AFSEL_R |= 0x30;
+    GPIO_PORTC_DATA_R &= 0x9F;
+    if (rxMode == 1)
     {
-        GREEN_LED ^= 1;
-        changeTimer1Value(200000);
+        //uDMA stops at any errored character, so the break character stays in the FIFO for Uart1Isr
+        UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2 | UART_LCRH_FEN;
+        UART1_IM_R = UART_IM_BEIM | UART_IM_FEIM | UART_IM_OEIM;
+        UART1_DMACTL_R = UART_DMACTL_RXDMAE | UART_DMACTL_DMAERR;
+        rxDmaValid = 0;
+        rxBegin();
+        startRxDma();
+    }
+    else
+    {
+        //interrupt at 8 characters, leaving 8 slot times to drain before the FIFO overruns.
+        //The repeater interrupts at 2 characters to keep the outputs close behind.
+        UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2 | UART_LCRH_FEN;
+        UART1_IFLS_R = repeat ? UART_IFLS_RX1_8 : UART_IFLS_RX4_8;
+        //the break interrupts right away so the break character is read while the line is still low
+        UART1_IM_R = UART_IM_RXIM | UART_IM_RTIM | UART_IM_OEIM | UART_IM_BEIM;
+    }
+    rxState = 0;
+    UART1_CTL_R = UART_CTL_RXE | UART_CTL_UARTEN;
+}
+
+/**
+ * @brief
+ *
+ * Function to handle UART1 interrupts of the uDMA receive engine. The break restarts the transfer,
+ * the end of the transfer validates and commits the frame.
+ */
+void rxDmaIsr()
+{
+
+    uint32_t status = UART1_MIS_R;
+
+    rxIsrCount++;
+    if (UDMA_CHIS_R & (1 << UDMA_CH_UART1RX))
+    {
+        //start code and 512 slots received
+        UDMA_CHIS_R = 1 << UDMA_CH_UART1RX;
+        if (rxDmaValid && dmxData[-1] == 0)
+        {
+            rxCommit(512);
+        }
+        else if (rxDmaValid)
+        {
+            rxStats.startCodes++;
+        }
+        //an invalid transfer was already counted as a bad break, framing error or overrun
+        rxAbort();
+        rxDmaValid = 0;
+        rxState = 0;
+    }
 
+    if (status & UART_MIS_BEMIS)
+    {
+        //the break ends a frame shorter than 512 slots
+        UDMA_ENACLR_R = 1 << UDMA_CH_UART1RX;
+        if (rxDmaValid)
+        {
+            uint16_t received = 512
+                    - ((udmaControlTable[UDMA_CH_UART1RX * 4 + 2] & UDMA_CHCTL_XFERSIZE_M)
+                            >> UDMA_CHCTL_XFERSIZE_S);
+            if (received > 0 && dmxData[-1] == 0)
+            {
+                rxCommit(received - 1);
+            }
+            else if (received > 0)
+            {
+                rxStats.startCodes++;
+            }
+        }
+        rxAbort();
+        countBreak();
+        armCapture();
+        while (!(UART1_FR_R & UART_FR_RXFE))
+        {
+            UART1_DR_R;
+        }
+        UART1_ECR_R = 0;
+        UART1_ICR_R = UART_ICR_BEIC | UART_ICR_FEIC | UART_ICR_OEIC;
+
+        //there is at least the mark after break before the start code arrives
+        rxBegin();
+        startRxDma();
+        rxDmaValid = 1;
+        changeTimer1Value(2000000);
+        TIMER1_CTL_R |= TIMER_CTL_TAEN;
+        rxState = 1;
+        rxError = 0;
+        GREEN_LED = 1;
     }
-    if (mode == 1 && continuous)
+    else if (status & (UART_MIS_FEMIS | UART_MIS_OEMIS))
     {
-        //using state machine-like interrupt handling
-        //Diagram Used for reference: http://www.etcconnect.com/Support/Articles/DMX-Speed.aspx
-        if (DMXMode == 0)
+        //discard the errored character so the transfer continues, the frame is dropped when it stops
+        if (status & UART_MIS_FEMIS)
         {
-            //Break
-            //send nothing
-            GPIO_PORTC_AFSEL_R &= 0x00;
-            GPIO_PORTC_DATA_R &= 0xDF;
-            changeTimer1Value(176); //For Break
-            DMXMode++;
+            rxStats.framingErrors++;
         }
-        else if (DMXMode == 1)
+        if (status & UART_MIS_OEMIS)
         {
-            //Mark After Break
-            GPIO_PORTC_DATA_R |= 0x20;
-            changeTimer1Value(12); //For MAB
-            DMXMode++;
+            rxStats.overruns++;
         }
-        else if (DMXMode == 2)
+        if (rxDmaValid)
         {
-            //Start Code with post start(2 stop bits)
-            TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
-            UART1_CTL_R = UART_CTL_TXE | UART_CTL_UARTEN | UART_CTL_EOT;
-            GPIO_PORTC_AFSEL_R |= 0x30;
-            DMXMode++;
-            putcUart1(0);
-
+            rxStats.dropped++;
+        }
+        rxDmaValid = 0;
+        while (!(UART1_FR_R & UART_FR_RXFE))
+        {
+            UART1_DR_R;
         }
+        UART1_ECR_R = 0;
+        UART1_ICR_R = UART_ICR_FEIC | UART_ICR_OEIC;
     }
+}
 
-    if (mode == 0)
+/**
+ * @brief
+ *
+ * Function to configure UART1 for the selected transmit engine. UART1 stays enabled from frame to frame.
+ */
+void configTxUart()
+{
+
+    UART1_CTL_R = 0;
+    UART1_DMACTL_R = 0;
+    UDMA_ENACLR_R = 1 << UDMA_CH_UART1RX;
+    if (txMode == 1)
+    {
+        UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2 | UART_LCRH_FEN;
+        UART1_DMACTL_R = UART_DMACTL_TXDMAE;
+        UART1_CTL_R = UART_CTL_TXE | UART_CTL_UARTEN | UART_CTL_EOT;
+    }
+    else if (txMode == 2)
+    {
+        UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2 | UART_LCRH_FEN;
+        UART1_IFLS_R = UART_IFLS_TX1_8;
+        UART1_CTL_R = UART_CTL_TXE | UART_CTL_UARTEN;
+    }
+    else
     {
+        UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2;
+        UART1_CTL_R = UART_CTL_TXE | UART_CTL_UARTEN | UART_CTL_EOT;
+    }
+    GPIO_PORTC_AFSEL_R |= 0x30;
+    txUartMode = txMode;
+}
 
-        if (rxState == 0 && !rxError)
+/**
+ * @brief
+ *
+ * Function to start the break. UART1 holds the line low by itself, Timer1 ends the break after breakTime.
+ */
+void startBreak()
+{
+
+    uint32_t now = TIMESTAMP;
+    uint32_t period = now - lastBreak;
+
+    uint8_t i;
+
+    if (flashHold)
+    {
+        //the line stays at mark until releaseOutput() once the flash is written
+        TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+        flashHold = 2;
+        return;
+    }
+    if (txUartMode != txMode)
+    {
+        configTxUart();
+    }
+
+    //publish the back universes for the next frame and latch their slot counts
+    txSlots = 0;
+    txPorts = 0;
+    for (i = 0; i < DMX_PORTS; ++i)
+    {
+        if (ports[i].enabled)
         {
-            changeTimer1Value(2000000);
-            TIMER1_CTL_R |= TIMER_CTL_TAEN;
-            rxError = 1;
+            txPorts |= 1 << i;
+            swapDMX(i);
+            ports[i].slots = ports[i].maxSlots;
+            if (autoSlots)
+            {
+                ports[i].slots = ports[i].frontSlots < 24 ? 24 : ports[i].frontSlots;
+                if (ports[i].slots > ports[i].maxSlots)
+                {
+                    ports[i].slots = ports[i].maxSlots;
+                }
+            }
+            if (ports[i].slots > txSlots)
+            {
+                txSlots = ports[i].slots;
+            }
+            UART_REG(ports[i].base, UART_O_LCRH) |= UART_LCRH_BRK;
         }
-        else if (rxError)
-        {
-            changeTimer1Value(500000);
-            GREEN_LED ^= 1;
+    }
 
+    //frame rate and jitter over one second windows
+    if (lastBreakValid)
+    {
+        if (period < fpsWindowMin)
+        {
+            fpsWindowMin = period;
         }
-        else if (rxState == 1)
+        if (period > fpsWindowMax)
         {
-            rxError = 0;
-            rxState = 0;
+            fpsWindowMax = period;
+        }
+        fpsWindowFrames++;
+        if (now - fpsWindowStart >= 40000000)
+        {
+            achievedFps = fpsWindowFrames;
+            frameJitter = fpsWindowMax - fpsWindowMin;
+            fpsWindowFrames = 0;
+            fpsWindowMin = 0xFFFFFFFF;
+            fpsWindowMax = 0;
+            fpsWindowStart = now;
         }
     }
-    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+    else
+    {
+        fpsWindowStart = now;
+        lastBreakValid = 1;
+    }
+    lastBreak = now;
+
+    //the universes were just published, compute the effect step of the next frame while this one is sent
+    triggerEffects();
+
+    changeTimer1Value(breakTime);
+    DMXMode = 1;
 }
 
 /**
  * @brief
  *
- * Function to convert integer to character for UART0
+ * Function to calculate the idle time between the end of a frame and the next break in microseconds.
+ * Stretches the break to break period to the target refresh rate, but never below the 1204 us DMX minimum.
+ * Called as the frame ends, so the time since the break includes interrupt latency and any gaps between slots.
  */
-char* intToChar(uint16_t x /**< [in] integer to convert to char*/)
+uint32_t frameGap()
 {
 
-    int8_t i = 2;
+    uint32_t frame = (TIMESTAMP - lastBreak) / 40;
+    uint32_t period = 1204;
 
-    uint16_t temp = x;
-    for (; i >= 0; --i)
+    if (refreshRate > 0 && 1000000 / refreshRate > period)
     {
-        ch[i] = '0' + temp % 10;
-        temp /= 10;
+        period = 1000000 / refreshRate;
     }
-    return ch;
+    return frame < period ? period - frame : 0;
 }
 
 /**
  * @brief
  *
- * Blocking function that writes a serial character when the UART buffer is not full
+ * Function to refill the TX FIFO of a port with the next slots. Switches to end of transmission interrupt once the last slot is queued.
  */
-void putcUart0(char c /**< [in] character to send to UART0*/)
+void fillPortFifo(uint8_t i /**< [in] port to refill */)
 {
 
-    while (UART0_FR_R & UART_FR_TXFF)
-        ;               // wait if uart0 tx fifo full
-    UART0_DR_R = c;                                  // write character to fifo
+    dmxPort* port = &ports[i];
+
+    while (port->next < port->slots
+            && !(UART_REG(port->base, UART_O_FR) & UART_FR_TXFF))
+    {
+        UART_REG(port->base, UART_O_DR) = port->front[port->next++];
+    }
+    if (port->next >= port->slots)
+    {
+        UART_REG(port->base, UART_O_CTL) |= UART_CTL_EOT;
+    }
 }
 
 /**
  * @brief
  *
- * Blocking function that writes a string when the UART buffer is not full
+ * Function to call when a port has transmitted its last slot. Once all ports are done, idles
+ * (mark before break) until the target period is reached and starts the next break.
  */
-void putsUart0(char* str /**< [in] character array to write to UART0 */)
+void endPortFrame(uint8_t i /**< [in] port that is done */)
 {
 
-    uint8_t i;
-    for (i = 0; i < strlen(str); i++)
-        putcUart0(str[i]);
+    uint32_t gap;
+
+    portsBusy &= ~(1 << i);
+    if (portsBusy == 0 && DMXMode == 3)
+    {
+        DMXMode = 0;
+        if (continuous)
+        {
+            gap = frameGap();
+            txGap = gap;
+            if (gap > 0)
+            {
+                changeTimer1Value(gap);
+            }
+            else
+            {
+                startBreak();
+            }
+        }
+    }
 }
 
 /**
  * @brief
  *
- * Blocking function that returns with serial data once the buffer is not empty
+ * Function to handle TX FIFO interrupts of UART2, 3, 5, 6, 7
  */
-char getcUart0()
+void portIsr(uint8_t i /**< [in] port that interrupted */)
 {
 
-    if (!(UART0_FR_R & UART_FR_RXFE))             // wait if uart0 rx fifo empty
-        return UART0_DR_R & 0xFF;                     // get character from fifo
+    UART_REG(ports[i].base, UART_O_ICR) = UART_ICR_TXIC;
+    if (repeat || merge)
+    {
+        repeatForward();
+        return;
+    }
+    if (DMXMode != 3 || !(portsBusy & (1 << i)))
+    {
+        return;
+    }
+    if (ports[i].next < ports[i].slots)
+    {
+        fillPortFifo(i);
+    }
     else
-        return '\0';
+    {
+        endPortFrame(i);
+    }
 }
 
 /**
  * @brief
  *
- * Function to get the launchpad mode from EEPROM
+ * Function to queue the received characters of the current frame to the repeater outputs
  */
-void getModeEE()
+void repeatForward()
 {
 
-    while (EEPROM_EEDONE_R & 0x01)
-        ;
-    delay6Cycles();
-    EEPROM_EEBLOCK_R = 0;
-    EEPROM_EEOFFSET_R = 2;
-    mode = (uint16_t) EEPROM_EERDWR_R;
-    delay6Cycles();
-    EEPROM_EEBLOCK_R = 1;
-    EEPROM_EEOFFSET_R = 2;
-    deviceModeAddress = (uint16_t) EEPROM_EERDWR_R;
+    uint8_t i;
+    uint8_t done = 1;
+    dmxPort* port;
+
+    if (repState != 3 || repSource == 0)
+    {
+        return;
+    }
+    for (i = 1; i < repPorts; ++i)
+    {
+        port = &ports[i];
+        while (port->next < repAvailable
+                && !(UART_REG(port->base, UART_O_FR) & UART_FR_TXFF))
+        {
+            if (port->next == 0 && i == 1)
+            {
+                repSlotLatency = TIMESTAMP - repInStart;
+                if (repSlotLatency > repMaxSlotLatency)
+                {
+                    repMaxSlotLatency = repSlotLatency;
+                }
+            }
+            UART_REG(port->base, UART_O_DR) = repSource[port->next - 1];
+            port->next++;
+        }
+        if (port->next < repAvailable)
+        {
+            done = 0;
+        }
+    }
+
+    //merged frame fully queued, send the newest merge next
+    if (merge && done)
+    {
+        startMergeFrame();
+    }
 }
 
 /**
  * @brief
  *
- * Function to write to EEPROM to set address
+ * Function to stop the repeater outputs wherever they are in a frame. Timer 3 is stopped and any break is ended,
+ * so a later repeat or merge starts from a clean state.
  */
-void EEWRITE(uint16_t B /**< [in] block address */, uint16_t offSet /**< [in] offset address */, uint16_t val /**< [in]value to write */)
+void stopRepeater()
 {
 
-    EEPROM_EEBLOCK_R = B;
-    EEPROM_EEOFFSET_R = offSet;
-    EEPROM_EERDWR_R = val;
+    uint8_t i;
+
+    TIMER3_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+    for (i = 1; i < DMX_PORTS; ++i)
+    {
+        UART_REG(ports[i].base, UART_O_LCRH) &= ~UART_LCRH_BRK;
+        ports[i].next = 0;
+    }
+    repState = 3;
+    repSource = 0;
+    repAvailable = 0;
 }
 
 /**
  * @brief
  *
- * Function to clear DMX data bins.
+ * Function to run the receive state machine of merge input B for one character read from UART7
  */
-void clearDMX()
+void mergeRxByte(uint16_t dr /**< [in] UART7 data register value with error flags */)
 {
 
-    uint16_t i = 0;
-    for (i = 0; i < 512; ++i)
+    if (dr & UART_DR_BE)
+    {
+        //the break ends a frame shorter than 512 slots
+        if (mergeState >= 2)
+        {
+            mergeCommit(mergeState - 2);
+        }
+        mergeState = 1;
+    }
+    else if (dr & UART_DR_FE)
+    {
+        mergeState = 0;
+    }
+    else if (mergeState == 1)
+    {
+        mergeState = (dr & 0xFF) == 0 ? 2 : 0;
+    }
+    else if (mergeState >= 2 && mergeState < 514)
     {
-        dmxData[i] = 0;
+        mergeBack[mergeState - 2] = dr & 0xFF;
+        mergeState++;
+        if (mergeState == 514)
+        {
+            mergeCommit(512);
+            mergeState = 0;
+        }
     }
 }
 
 /**
  * @brief
  *
- * Function to parse commands from UART0 and execute functions or set flags.
+ * Function to make a frame of input B of 24 to 512 slots available to the merge. Shorter frames are dropped.
  */
-uint8_t parseCommand()
+void mergeCommit(uint16_t slots /**< [in] number of DMX Bins received */)
 {
 
-    if (mode == 1)
-    { //controller mode
-        if (strcmp(command, "device") == 0)
-        {
-            TIMER1_CTL_R |= TIMER_CTL_TAEN;
-            UART1_IFLS_R = UART_IFLS_RX1_8;
-            UART1_IM_R = UART_IM_RXIM;
-            GPIO_PORTC_AFSEL_R |= 0x30;
-            GPIO_PORTC_DATA_R &= 0x9F;
-            UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2;
-            UART1_CTL_R = UART_CTL_RXE | UART_CTL_UARTEN;
+    uint8_t* temp;
 
-            putsUart0("\n\rDevice Mode\n\r");
-            mode = 0;
-            EEWRITE(0, 2, 0);
+    if (slots < 24)
+    {
+        return;
+    }
+    if (slots < 512)
+    {
+        memset(mergeBack + slots, 0, 512 - slots);
+    }
+    temp = mergeFront;
+    mergeFront = mergeBack;
+    mergeBack = temp;
+    mergeSlotsB = slots;
+    mergeLastB = TIMESTAMP;
+    mergeFramesB++;
+    mergeUniverses(1);
+}
+
+/**
+ * @brief
+ *
+ * Function to merge input A (universe 1) and input B into the back universe of universe 2.
+ * Called when either input has a new frame. Inputs without a frame for MERGE_TIMEOUT are left out.
+ */
+void mergeUniverses(uint8_t source /**< [in] input with the new frame. 0: A, 1: B */)
+{
+
+    uint32_t now = TIMESTAMP;
+    uint32_t* a = (uint32_t*) dmxFront;
+    uint32_t* b = (uint32_t*) mergeFront;
+    uint32_t* out = (uint32_t*) ports[1].back;
+    uint32_t* in;
+    uint32_t* last;
+    uint32_t x, y, ge, mask, changed;
+    uint8_t aliveA = rxStats.frames > 0 && now - rxStats.lastGood < MERGE_TIMEOUT;
+    uint8_t aliveB = mergeFramesB > 0 && now - mergeLastB < MERGE_TIMEOUT;
+    uint8_t i, j;
+
+    mergeSlots = 0;
+    if (aliveA)
+    {
+        mergeSlots = rxStats.slots;
+    }
+    if (aliveB && mergeSlotsB > mergeSlots)
+    {
+        mergeSlots = mergeSlotsB;
+    }
+
+    if (merge == 1)
+    {
+        for (i = 0; i < 128; ++i)
+        {
+            x = aliveA ? a[i] : 0;
+            y = aliveB ? b[i] : 0;
+
+            //per byte x >= y: compare the low 7 bits without borrows between bytes, then fix up with the top bits
+            ge = (x | 0x80808080) - (y & 0x7F7F7F7F);
+            ge = ((x & ~y) | (~(x ^ y) & ge)) & 0x80808080;
+            mask = (ge >> 7) * 0xFF;
+            out[i] = (x & mask) | (y & ~mask);
+        }
+    }
+    else
+    {
+        //latest change wins, only words the input changed are looked at byte by byte
+        in = source ? b : a;
+        last = ltpLast[source];
+        for (i = 0; i < 128; ++i)
+        {
+            changed = in[i] ^ last[i];
+            if (changed)
+            {
+                for (j = 0; j < 32; j += 8)
+                {
+                    if (changed & (0xFFu << j))
+                    {
+                        ltpOut[i] = (ltpOut[i] & ~(0xFFu << j)) | (in[i] & (0xFFu << j));
+                    }
+                }
+                last[i] = in[i];
+            }
+            out[i] = ltpOut[i];
+        }
+    }
+
+    //the whole universe was written, no sync from the front universe needed
+    ports[1].back[-1] = 0;
+    ports[1].stale = 0;
+    ports[1].backSlots = mergeSlots;
+    ports[1].dirty = 1;
+    mergeTicks = TIMESTAMP - now;
+    startMergeFrame();
+}
+
+/**
+ * @brief
+ *
+ * Function to send the newest merged universe on UART2, 3, 5, 6 once the previous one has been queued
+ */
+void startMergeFrame()
+{
+
+    uint8_t i;
+
+    if (!ports[1].dirty || repState != 3)
+    {
+        return;
+    }
+    for (i = 1; i < repPorts; ++i)
+    {
+        if (ports[i].next < repAvailable)
+        {
+            return;
+        }
+    }
+    swapDMX(1);
+    repSource = ports[1].front;
+    repAvailable = ports[1].frontSlots + 1;
+    repState = 0;
+    changeTimer3Value(1);
+}
+
+/**
+ * @brief
+ *
+ * Function to hand PE0 to U7RX and take UART7 out of the outputs while merging, and to give them back when merge is off.
+ */
+void configMergeUart()
+{
+
+    if (merge)
+    {
+        GPIO_PORTE_DEN_R |= 0x01;
+        GPIO_PORTE_PCTL_R = (GPIO_PORTE_PCTL_R & ~GPIO_PCTL_PE0_M) | GPIO_PCTL_PE0_U7RX;
+        GPIO_PORTE_AFSEL_R |= 0x01;
+        UART7_CTL_R |= UART_CTL_RXE;
+        UART7_IFLS_R = UART_IFLS_TX1_8 | UART_IFLS_RX4_8;
+        UART7_IM_R = UART_IM_RXIM | UART_IM_RTIM | UART_IM_OEIM | UART_IM_BEIM;
+        repPorts = MERGE_PORT;
+    }
+    else
+    {
+        UART7_IM_R = UART_IM_TXIM;
+        UART7_CTL_R &= ~UART_CTL_RXE;
+        GPIO_PORTE_AFSEL_R &= ~0x01;
+        GPIO_PORTE_PCTL_R &= ~GPIO_PCTL_PE0_M;
+        repPorts = DMX_PORTS;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Timer 3 interrupts. Times the break and mark after break of the repeater outputs.
+ */
+void Timer3ISR()
+{
+
+    uint8_t i;
+
+    TIMER3_ICR_R = TIMER_ICR_TATOCINT;
+    if (repState == 0)
+    {
+        //let the outputs finish the last slots of the previous frame
+        for (i = 1; i < repPorts; ++i)
+        {
+            if (UART_REG(ports[i].base, UART_O_FR) & UART_FR_BUSY)
+            {
+                changeTimer3Value(44);
+                return;
+            }
+        }
+        for (i = 1; i < repPorts; ++i)
+        {
+            UART_REG(ports[i].base, UART_O_LCRH) |= UART_LCRH_BRK;
+            ports[i].next = 0;
+        }
+        repBreakLatency = TIMESTAMP - rxStats.lastBreak;
+        changeTimer3Value(breakTime);
+        repState = 1;
+    }
+    else if (repState == 1)
+    {
+        for (i = 1; i < repPorts; ++i)
+        {
+            UART_REG(ports[i].base, UART_O_LCRH) &= ~UART_LCRH_BRK;
+        }
+        changeTimer3Value(mabTime);
+        repState = 2;
+    }
+    else
+    {
+        //the mark after break stretches until the start code has been received
+        repState = 3;
+        repeatForward();
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Interrupts from UART2 (universe 2)
+ */
+void Uart2Isr()
+{
+
+    portIsr(1);
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Interrupts from UART3 (universe 3)
+ */
+void Uart3Isr()
+{
+
+    portIsr(2);
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Interrupts from UART5 (universe 4)
+ */
+void Uart5Isr()
+{
+
+    portIsr(3);
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Interrupts from UART6 (universe 5)
+ */
+void Uart6Isr()
+{
+
+    portIsr(4);
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Interrupts from UART7 (universe 6, merge input B)
+ */
+void Uart7Isr()
+{
+
+    if (merge
+            && (UART7_MIS_R
+                    & (UART_MIS_RXMIS | UART_MIS_RTMIS | UART_MIS_OEMIS
+                            | UART_MIS_BEMIS)))
+    {
+        UART7_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC | UART_ICR_OEIC
+                | UART_ICR_BEIC;
+        if (UART7_RSR_R & UART_RSR_OE)
+        {
+            UART7_ECR_R = 0;
+            mergeState = 0;
+        }
+        while (!(UART7_FR_R & UART_FR_RXFE))
+        {
+            mergeRxByte(UART7_DR_R);
+        }
+        return;
+    }
+    portIsr(5);
+}
+
+/**
+ * @brief
+ *
+ * Function to find the highest non-zero bin of a universe. Returns 0 if all bins are zero.
+ */
+uint16_t highestSlot(uint8_t* data /**< [in] universe to search */)
+{
+
+    int16_t i = 127;
+
+    while (i >= 0 && ((uint32_t*) data)[i] == 0)
+    {
+        i--;
+    }
+    if (i < 0)
+    {
+        return 0;
+    }
+    i = i * 4 + 3;
+    while (data[i] == 0)
+    {
+        i--;
+    }
+    return i + 1;
+}
+
+/**
+ * @brief
+ *
+ * Function to call before writing to the back universe. Syncs it with the front universe after a swap.
+ */
+void beginDMXWrite(uint8_t u /**< [in] universe index */)
+{
+
+    uint8_t i;
+    dmxPort* port = &ports[u];
+
+    //a writer that preempts the copy would have its slots overwritten by the rest of it
+    disableInterrupts();
+    port->writing++;
+    if (port->stale)
+    {
+        for (i = 0; i < 128; ++i)
+        {
+            ((uint32_t*) port->back)[i] = ((uint32_t*) port->front)[i];
+        }
+        port->stale = 0;
+    }
+    enableInterrupts();
+}
+
+/**
+ * @brief
+ *
+ * Function to call after writing to the back universe. Marks it to be published at the next frame boundary.
+ */
+void endDMXWrite(uint8_t u /**< [in] universe index */)
+{
+
+    dmxPort* port = &ports[u];
+    uint16_t slots = highestSlot(port->back);
+
+    disableInterrupts();
+    port->backSlots = slots;
+    port->dirty = 1;
+    port->writing--;
+    enableInterrupts();
+}
+
+/**
+ * @brief
+ *
+ * Function to call instead of endDMXWrite when a write is abandoned. The back universe is synced with the front
+ * universe again at once, so the half written universe is never published.
+ */
+void abortDMXWrite(uint8_t u /**< [in] universe index */)
+{
+
+    uint8_t i;
+    dmxPort* port = &ports[u];
+
+    disableInterrupts();
+    for (i = 0; i < 128; ++i)
+    {
+        ((uint32_t*) port->back)[i] = ((uint32_t*) port->front)[i];
+    }
+    port->backSlots = port->frontSlots;
+    port->stale = 0;
+    port->dirty = 0;
+    port->writing--;
+    enableInterrupts();
+}
+
+/**
+ * @brief
+ *
+ * Function to publish the back universe by swapping pointers. Only called at a frame boundary.
+ */
+void swapDMX(uint8_t u /**< [in] universe index */)
+{
+
+    uint8_t* temp;
+    dmxPort* port = &ports[u];
+
+    if (port->dirty && !port->writing)
+    {
+        temp = port->front;
+        port->front = port->back;
+        port->back = temp;
+        port->frontSlots = port->backSlots;
+        port->dirty = 0;
+        port->stale = 1;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to change load value of Timer1
+ */
+void changeTimer1Value(uint32_t us /**< [in] time in microseconds to convert to load value */)
+{
+
+    TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER1_TAILR_R = us * 40;             // turn-off timer before reconfiguring
+    // reset interrupt
+    // set load value to 2e5 for 200 Hz interrupt rate
+    TIMER1_CTL_R |= TIMER_CTL_TAEN;
+}
+
+/**
+ * @brief
+ *
+ * Function to start the Timer 3 one shot
+ */
+void changeTimer3Value(uint32_t us /**< [in] time in microseconds to convert to load value */)
+{
+
+    TIMER3_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER3_TAILR_R = us * 40;
+    TIMER3_CTL_R |= TIMER_CTL_TAEN;
+}
+
+/**
+ * @brief
+ *
+ * Function to Handle Interrupts from Timer2. Triggered once per frame at the break, computes one effect step
+ * into the back universe, which is sent from the next break on.
+ */
+void Timer2ISR()
+{
+
+    uint32_t start = TIMESTAMP;
+    uint8_t writing = (woo == 4 || playing || cueRequest >= 0 || generating()
+            || fading());
+
+    if (writing)
+    {
+        beginDMXWrite(0);
+    }
+
+    if (woo == 4)
+    {
+        if (servoDir == 0)
+        {
+            dmxData[deviceModeAddress + 0 - 1]--;
+        }
+        else
+        {
+            dmxData[deviceModeAddress + 0 - 1]++;
+        }
+
+    }
+
+    if (writing)
+    {
+        stepCues();
+        stepGenerators();
+        fadeStep10ms();
+        endDMXWrite(0);
+    }
+
+    effectCycles = TIMESTAMP - start;
+    if (effectCycles > effectMax)
+    {
+        effectMax = effectCycles;
+    }
+    effectBusy = 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to trigger the effects of the next frame. Called by the transmit and receive state machines at the break.
+ */
+void triggerEffects()
+{
+
+    if (effectBusy)
+    {
+        effectOverruns++;
+        return;
+    }
+    effectBusy = 1;
+    NVIC_SW_TRIG_R = INT_TIMER2A - 16;
+}
+
+/**
+ * @brief
+ *
+ * Function to write one step of every effect generator into the back universe. Table lookups and one multiply per channel,
+ * no float math.
+ */
+void stepGenerators()
+{
+
+    uint8_t i;
+    uint16_t ch;
+    uint16_t phase;
+    effectGenerator* gen;
+
+    for (i = 0; i < GENERATORS; ++i)
+    {
+        gen = &generators[i];
+        if (gen->wave == 0)
+        {
+            continue;
+        }
+        phase = gen->phase;
+        for (ch = gen->first; ch <= gen->last; ++ch)
+        {
+            dmxData[ch] = (gen->wave[phase >> 8] * gen->amplitude) >> 8;
+            phase += gen->spread;
+        }
+        gen->phase += gen->rate;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to step cue playback by one frame. Recalling a cue snapshots the universe and points at the new scene, the
+ * crossfade between them is computed into the back universe frame by frame.
+ */
+void stepCues()
+{
+
+    uint32_t elapsed = (TIMESTAMP - xfLast) / 400000;
+    uint32_t in, out;
+    int32_t d;
+    uint16_t ch;
+    cue* c;
+
+    xfLast += elapsed * 400000;
+    xfTicks += elapsed;
+
+    if (cueRequest >= 0)
+    {
+        if (cueRequest < CUES && cues[cueRequest].used == 1
+                && cues[cueRequest].scene < SCENES)
+        {
+            cueCurrent = cueRequest;
+            memcpy(xfSnapshot, dmxData, 512);
+            xfFrom = (const uint8_t*) xfSnapshot;
+            xfTo = (const uint8_t*) (SCENE_BASE + cues[cueCurrent].scene * 512);
+            xfTicks = 0;
+            playing = 1;
+        }
+        else
+        {
+            playing = 0;
+        }
+        cueRequest = -1;
+    }
+
+    c = &cues[cueCurrent];
+    if (playing == 2)
+    {
+        //follow on to the next cue
+        if (xfTicks >= c->wait)
+        {
+            cueRequest = cueCurrent + 1;
+        }
+        return;
+    }
+    if (playing != 1)
+    {
+        return;
+    }
+
+    //Q16 progress of the channels going up and down
+    in = xfTicks >= c->fadeIn ? 65536 : (xfTicks << 16) / c->fadeIn;
+    out = xfTicks >= c->fadeOut ? 65536 : (xfTicks << 16) / c->fadeOut;
+    for (ch = 0; ch < 512; ++ch)
+    {
+        d = xfTo[ch] - xfFrom[ch];
+        dmxData[ch] = xfFrom[ch] + ((d * (int32_t) (d > 0 ? in : out)) >> 16);
+    }
+    if (in == 65536 && out == 65536)
+    {
+        xfTicks = 0;
+        playing = c->wait ? 2 : 0;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to erase a 1 KB flash page. The CPU stalls while the page is erased.
+ */
+void flashErase(uint32_t address /**< [in] page address */)
+{
+
+    FLASH_FMA_R = address;
+    FLASH_FMC_R = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+    while (FLASH_FMC_R & FLASH_FMC_ERASE);
+}
+
+/**
+ * @brief
+ *
+ * Function to program words into erased flash
+ */
+void flashWrite(uint32_t address /**< [in] word aligned flash address */, const uint32_t* data /**< [in] words to write */,
+        uint16_t words /**< [in] number of words */)
+{
+
+    uint16_t i;
+
+    for (i = 0; i < words; ++i)
+    {
+        FLASH_FMD_R = data[i];
+        FLASH_FMA_R = address + i * 4;
+        FLASH_FMC_R = FLASH_FMC_WRKEY | FLASH_FMC_WRITE;
+        while (FLASH_FMC_R & FLASH_FMC_WRITE);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to stop the DMX output at the next frame boundary. Instructions are fetched from flash, so every
+ * interrupt stalls while a page is erased or programmed; the line is left at mark instead of stopping mid frame.
+ */
+void holdOutput()
+{
+
+    if (mode != 1)
+    {
+        return;
+    }
+    flashHold = 1;
+    while (continuous ? flashHold == 1 : DMXMode != 0)
+    {
+        waitForInterrupt();
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to restart the DMX output held by holdOutput(), with a break right away.
+ */
+void releaseOutput()
+{
+
+    if (flashHold == 2)
+    {
+        flashHold = 0;
+        changeTimer1Value(1);
+    }
+    flashHold = 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to store 512 levels as a scene. The other scene of the flash page is kept.
+ * The output is held at mark for the few ms the page takes to erase and program.
+ */
+void recordScene(uint8_t n /**< [in] scene number */, const uint8_t* levels /**< [in] word aligned levels */)
+{
+
+    uint32_t page = SCENE_BASE + (n >> 1) * 1024;
+    uint32_t other = page + ((n & 1) ? 0 : 512);
+
+    memcpy(sceneCopy, (const void*) other, 512);
+    holdOutput();
+    flashErase(page);
+    flashWrite(SCENE_BASE + n * 512, (const uint32_t*) levels, 128);
+    flashWrite(other, sceneCopy, 128);
+    releaseOutput();
+}
+
+/**
+ * @brief
+ *
+ * Function to write the cue list back to its flash page
+ */
+void saveCues()
+{
+
+    holdOutput();
+    flashErase(CUE_BASE);
+    flashWrite(CUE_BASE, (const uint32_t*) cues, sizeof(cues) / 4);
+    releaseOutput();
+}
+
+/**
+ * @brief
+ *
+ * Function to take one byte of a show image from UART0. The image is "DMXS", a version byte, then records:
+ * 'S' scene, runs of (length, first channel, levels) ending with a length of 0, each against the previous scene,
+ * then a 16-bit sum of the scene record from the 'S' on, checked before the scene is written to flash; 'C' cue, n, scene, fade in, fade out, wait; 'G' generator, g, waveform, first, last, rate, spread, amplitude;
+ * 'E' end, 16-bit sum of every byte before it. Values are little endian. A '.' is sent back after each record so
+ * the host waits out the flash writes instead of overrunning the receive FIFO.
+ */
+void loadByte(uint8_t c /**< [in] received byte */)
+{
+
+    const uint8_t sizes[4] = { 8, 12, 2, 0 };
+
+    if (!(loading == 3 && loadType == 'E'))
+    {
+        loadSum += c;
+    }
+    if (loading >= 4 && loading <= 6)
+    {
+        loadSceneSum += c;
+    }
+    switch (loading)
+    {
+    case 1:
+        if (c != (loadPos < 4 ? "DMXS"[loadPos] : SHOW_VERSION))
+        {
+            loadFail();
+            return;
+        }
+        if (++loadPos == 5)
+        {
+            loading = 2;
+        }
+        break;
+    case 2:
+        loadType = c;
+        loadPos = 0;
+        if (c == 'S')
+        {
+            loadSceneSum = c;
+            loading = 4;
+        }
+        else if (c == 'C' || c == 'G' || c == 'E')
+        {
+            loadLength = sizes[c == 'C' ? 0 : (c == 'G' ? 1 : 2)];
+            loading = 3;
+        }
+        else
+        {
+            loadFail();
+        }
+        break;
+    case 3:
+        loadRecord[loadPos++] = c;
+        if (loadPos == loadLength)
+        {
+            loadRecordDone();
+        }
+        break;
+    case 4:
+        if (c >= SCENES)
+        {
+            loadFail();
+            return;
+        }
+        loadSceneNumber = c;
+        loading = 5;
+        break;
+    case 5:
+        loadRecord[loadPos++] = c;
+        if (loadPos == 1 && c == 0)
+        {
+            //end of the scene, its sum follows
+            loadPos = 0;
+            loading = 7;
+        }
+        else if (loadPos == 3)
+        {
+            loadLength = loadRecord[0];
+            loadStart = loadRecord[1] | (loadRecord[2] << 8);
+            if (loadStart + loadLength > 512)
+            {
+                loadFail();
+                return;
+            }
+            loadPos = 0;
+            loading = 6;
+        }
+        break;
+    case 6:
+        ((uint8_t*) loadScene)[loadStart + loadPos] = c;
+        if (++loadPos == loadLength)
+        {
+            loadPos = 0;
+            loading = 5;
+        }
+        break;
+    case 7:
+        loadRecord[loadPos++] = c;
+        if (loadPos == 2)
+        {
+            //a damaged scene never reaches flash
+            if (loadSceneSum != (loadRecord[0] | (loadRecord[1] << 8)))
+            {
+                loadFail();
+                return;
+            }
+            recordScene(loadSceneNumber, (const uint8_t*) loadScene);
+            ++loadScenes;
+            loading = 2;
+            putcUart0('.');
+        }
+        break;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to apply a complete cue, generator or end record of a show image
+ */
+void loadRecordDone()
+{
+
+    uint8_t* r = loadRecord;
+    uint8_t n = r[0];
+
+    if (loadType == 'C')
+    {
+        if (n >= CUES || r[1] >= SCENES)
+        {
+            loadFail();
+            return;
+        }
+        cues[n].scene = r[1];
+        cues[n].used = 1;
+        cues[n].fadeIn = r[2] | (r[3] << 8);
+        cues[n].fadeOut = r[4] | (r[5] << 8);
+        cues[n].wait = r[6] | (r[7] << 8);
+        ++loadCues;
+    }
+    else if (loadType == 'G')
+    {
+        if (n >= GENERATORS || r[1] >= 7)
+        {
+            loadFail();
+            return;
+        }
+        generators[n].wave = 0;
+        generators[n].first = r[2] | (r[3] << 8);
+        generators[n].last = r[4] | (r[5] << 8);
+        generators[n].phase = 0;
+        generators[n].rate = r[6] | (r[7] << 8);
+        generators[n].spread = r[8] | (r[9] << 8);
+        generators[n].amplitude = r[10] | (r[11] << 8);
+        if (generators[n].first <= generators[n].last && generators[n].last < 512
+                && generators[n].amplitude <= 256)
+        {
+            generators[n].wave = waves[r[1]];
+        }
+    }
+    else
+    {
+        if (loadSum != (r[0] | (r[1] << 8)))
+        {
+            loadFail();
+            return;
+        }
+        saveCues();
+        loading = 0;
+        putsUart0("\n\rLoaded ");
+        putsUart0(longToChar(loadScenes));
+        putsUart0(" scenes, ");
+        putsUart0(longToChar(loadCues));
+        putsUart0(" cues\r\n>");
+        return;
+    }
+    loadPos = 0;
+    loading = 2;
+    putcUart0('.');
+}
+
+/**
+ * @brief
+ *
+ * Function to abandon a show image load. Scenes already written stay, the cue list goes back to the one in flash.
+ */
+void loadFail()
+{
+
+    loading = 0;
+    memcpy(cues, (const void*) CUE_BASE, sizeof(cues));
+    rx0Tail = rx0Head;
+    putsUart0("\n\rLoad failed\r\n>");
+}
+
+/**
+ * @brief
+ *
+ * Function to check if any effect generator is on
+ */
+bool generating()
+{
+
+    uint8_t i;
+
+    for (i = 0; i < GENERATORS; ++i)
+    {
+        if (generators[i].wave)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *
+ * Function to check if any channel is fading
+ */
+bool fading()
+{
+
+    uint8_t i;
+
+    for (i = 0; i < 16; ++i)
+    {
+        if (fadeActive[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *
+ * Function to advance all fading channels of universe 1 by the whole 10 ms ticks elapsed since the last frame.
+ * The remainder is carried, so fade times stay exact whatever the frame rate.
+ */
+void fadeStep10ms()
+{
+
+    uint32_t elapsed = (TIMESTAMP - fadeLast) / 400000;
+    uint32_t active;
+    uint16_t ch;
+    uint8_t i;
+
+    if (elapsed == 0)
+    {
+        return;
+    }
+    fadeLast += elapsed * 400000;
+    for (i = 0; i < 16; ++i)
+    {
+        active = fadeActive[i];
+        for (ch = i << 5; active != 0; ++ch, active >>= 1)
+        {
+            if (!(active & 1))
+            {
+                continue;
+            }
+            if (elapsed >= fadeTicks[ch])
+            {
+                fadeLevel[ch] = fadeTarget[ch] << 16;
+                fadeTicks[ch] = 0;
+                fadeActive[i] &= ~(1u << (ch & 31));
+                if (woo == 5 && ch == deviceModeAddress - 1)
+                {
+                    putsUart0("Done Ramp\n\r");
+                    woo = 0;
+                }
+            }
+            else
+            {
+                fadeLevel[ch] += fadeStep[ch] * (int32_t) elapsed;
+                fadeTicks[ch] -= elapsed;
+            }
+            dmxData[ch] = (fadeLevel[ch] + 0x8000) >> 16;
+        }
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to start fading a range of channels of universe 1 from their current value. The Q16 step is only
+ * divided out again when a channel starts at a different level, so each channel costs a few stores.
+ */
+void startFade(uint16_t first /**< [in] first channel, 0 based */, uint16_t last /**< [in] last channel, 0 based */,
+        uint16_t value /**< [in] target value */, uint32_t ms /**< [in] fade time in milliseconds */)
+{
+
+    uint16_t ticks = ms / 10 > 65535 ? 65535 : ms / 10;
+    uint16_t ch;
+    int32_t from;
+    int32_t step;
+
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+
+    //the fade tick must not step a channel with the new level and the old step, or clear a bit just set
+    maskEffects();
+    if (!fading())
+    {
+        fadeLast = TIMESTAMP;
+    }
+
+    beginDMXWrite(0);
+    from = dmxData[first];
+    step = (((int32_t) value - from) << 16) / ticks;
+    for (ch = first; ch <= last; ++ch)
+    {
+        //channels of a range can start at different levels
+        if (dmxData[ch] != from)
+        {
+            from = dmxData[ch];
+            step = (((int32_t) value - from) << 16) / ticks;
+        }
+        fadeLevel[ch] = from << 16;
+        fadeStep[ch] = step;
+        fadeTicks[ch] = ticks;
+        fadeTarget[ch] = value;
+        fadeActive[ch >> 5] |= 1u << (ch & 31);
+    }
+    endDMXWrite(0);
+    unmaskEffects();
+}
+
+/**
+ * @brief
+ *
+ * Function to handle TIMER1 interrupts
+ */
+void Timer1ISR()
+{
+
+    uint8_t i;
+
+    if (mode == 3 && GREEN_LED == 0)
+    {
+        GREEN_LED ^= 1;
+        changeTimer1Value(15000);
+
+    }
+    if (mode == 3 && GREEN_LED == 1)
+    {
+        GREEN_LED ^= 1;
+        changeTimer1Value(200000);
+
+    }
+    if (mode == 1 && continuous)
+    {
+        //using state machine-like interrupt handling
+        //Diagram Used for reference: http://www.etcconnect.com/Support/Articles/DMX-Speed.aspx
+        if (DMXMode == 0)
+        {
+            //Break, after the idle time of the previous frame
+            startBreak();
+        }
+        else if (DMXMode == 1)
+        {
+            //Mark After Break
+            for (i = 0; i < DMX_PORTS; ++i)
+            {
+                if (txPorts & (1 << i))
+                {
+                    UART_REG(ports[i].base, UART_O_LCRH) &= ~UART_LCRH_BRK;
+                }
+            }
+            changeTimer1Value(mabTime);
+            DMXMode++;
+        }
+        else if (DMXMode == 2)
+        {
+            //Start Code with post start(2 stop bits)
+            TIMER1_CTL_R &= ~TIMER_CTL_TAEN;
+            DMXMode++;
+            portsBusy = 1;
+            if (txMode == 1)
+            {
+                //Slots are streamed by uDMA through the FIFO, UART1 interrupts once the line is idle
+                ports[0].next = ports[0].slots;
+                startTxDma(dmxFront - 1, ports[0].slots + 1);
+            }
+            else if (txMode == 2)
+            {
+                //FIFO interrupts when it drains to 2 entries, leaving room for 14 slots per refill
+                UART1_CTL_R &= ~UART_CTL_EOT;
+                ports[0].next = 0;
+                UART1_DR_R = dmxFront[-1];
+                fillPortFifo(0);
+            }
+            else
+            {
+                ports[0].next = 0;
+                putcUart1(dmxFront[-1]);
+            }
+
+            //other universes always use FIFO refill
+            for (i = 1; i < DMX_PORTS; ++i)
+            {
+                if (txPorts & (1 << i))
+                {
+                    portsBusy |= 1 << i;
+                    UART_REG(ports[i].base, UART_O_CTL) &= ~UART_CTL_EOT;
+                    ports[i].next = 0;
+                    UART_REG(ports[i].base, UART_O_DR) = ports[i].front[-1];
+                    fillPortFifo(i);
+                }
+            }
+
+        }
+    }
+
+    if (mode == 0)
+    {
+
+        //no break for 2 s, the frame rate and the break to break period start over
+        rxStats.fps = 0;
+        rxStats.windowFrames = 0;
+        rxStats.windowStart = TIMESTAMP;
+        rxBreakValid = 0;
+        capBreakValid = 0;
+
+        if (rxState == 0 && !rxError)
+        {
+            changeTimer1Value(2000000);
+            TIMER1_CTL_R |= TIMER_CTL_TAEN;
+            rxError = 1;
+        }
+        else if (rxError)
+        {
+            changeTimer1Value(500000);
+            GREEN_LED ^= 1;
+
+        }
+        else if (rxState == 1)
+        {
+            rxError = 0;
+            rxState = 0;
+        }
+    }
+    TIMER1_ICR_R = TIMER_ICR_TATOCINT;
+}
+
+/**
+ * @brief
+ *
+ * Function to convert integer to character for UART0
+ */
+char* intToChar(uint16_t x /**< [in] integer to convert to char*/)
+{
+
+    int8_t i = 2;
+
+    uint16_t temp = x;
+    ch[3] = '\0';
+    for (; i >= 0; --i)
+    {
+        ch[i] = '0' + temp % 10;
+        temp /= 10;
+    }
+    return ch;
+}
+
+/**
+ * @brief
+ *
+ * Function to convert unsigned long to character for UART0, without leading zeros
+ */
+char* longToChar(uint32_t x /**< [in] integer to convert to char*/)
+{
+
+    static char str[11];
+    int8_t i = 10;
+
+    str[i] = '\0';
+    do
+    {
+        str[--i] = '0' + x % 10;
+        x /= 10;
+    }
+    while (x > 0);
+    return &str[i];
+}
+
+/**
+ * @brief
+ *
+ * Function that writes a serial character without waiting. It goes straight to the FIFO when nothing is queued ahead
+ * of it, otherwise into the transmit ring; when the ring is full it is dropped and counted.
+ */
+void putcUart0(char c /**< [in] character to send to UART0*/)
+{
+
+    uint16_t next;
+    uint32_t basepri;
+
+    //written from the main loop and Timer2ISR, read by Uart0Isr, so only priority 2 and below are held off
+    basepri = _set_interrupt_priority(CONSOLE_BASEPRI);
+    next = (tx0Head + 1) & (TX0_SIZE - 1);
+    if (tx0Head == tx0Tail && !(UART0_FR_R & UART_FR_TXFF))
+    {
+        UART0_DR_R = c;                              // write character to fifo
+    }
+    else if (next != tx0Tail)
+    {
+        tx0Buffer[tx0Head] = c;
+        tx0Head = next;
+        UART0_IM_R |= UART_IM_TXIM;
+    }
+    else
+    {
+        ++tx0Overflows;
+    }
+    _set_interrupt_priority(basepri);
+}
+
+/**
+ * @brief
+ *
+ * Function to move queued console output into the UART0 FIFO. The transmit interrupt stays on while characters are
+ * queued; the ring only fills while the FIFO is full, so the FIFO falling below its level always raises it.
+ */
+void drainUart0()
+{
+
+    UART0_ICR_R = UART_ICR_TXIC;
+    while (tx0Tail != tx0Head && !(UART0_FR_R & UART_FR_TXFF))
+    {
+        UART0_DR_R = tx0Buffer[tx0Tail];
+        tx0Tail = (tx0Tail + 1) & (TX0_SIZE - 1);
+    }
+    if (tx0Tail == tx0Head)
+    {
+        UART0_IM_R &= ~UART_IM_TXIM;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function that queues a string for UART0 without waiting for the FIFO
+ */
+void putsUart0(char* str /**< [in] character array to write to UART0 */)
+{
+
+    while (*str)
+        putcUart0(*str++);
+}
+
+/**
+ * @brief
+ *
+ * Function that returns the next character of the console receive ring, or '\0' when it is empty
+ */
+char getcUart0()
+{
+
+    char c;
+
+    if (rx0Tail == rx0Head)
+        return '\0';
+    c = rx0Buffer[rx0Tail];
+    rx0Tail = (rx0Tail + 1) & (RX0_SIZE - 1);
+    return c;
+}
+
+/**
+ * @brief
+ *
+ * Function to get the launchpad mode from EEPROM
+ */
+void getModeEE()
+{
+
+    while (EEPROM_EEDONE_R & 0x01)
+        ;
+    delay6Cycles();
+    EEPROM_EEBLOCK_R = 0;
+    EEPROM_EEOFFSET_R = 2;
+    mode = (uint16_t) EEPROM_EERDWR_R;
+    delay6Cycles();
+    EEPROM_EEBLOCK_R = 1;
+    EEPROM_EEOFFSET_R = 2;
+    deviceModeAddress = (uint16_t) EEPROM_EERDWR_R;
+    delay6Cycles();
+    EEPROM_EEBLOCK_R = 2;
+    EEPROM_EEOFFSET_R = 2;
+    uint32_t c = EEPROM_EERDWR_R;
+    uint8_t o;
+    for (o = 0; o < 3; ++o)
+    {
+        //two bits per output, erased EEPROM gives linear
+        outputCurve[o] = c > 0x3F ? 0 : (c >> (o * 2)) & 3;
+    }
+    delay6Cycles();
+    EEPROM_EEOFFSET_R = 3;
+    personality = EEPROM_EERDWR_R == 1;
+    delay6Cycles();
+    EEPROM_EEOFFSET_R = 4;
+    c = EEPROM_EERDWR_R;
+    if (c == 0xFFFFFFFF)
+    {
+        c = personality ? PWM_PERIOD_16 | (PWM_PERIOD_16 << 16) : PWM_PERIOD | (PWM_PERIOD << 16);
+    }
+    pwmPeriod[0] = c;
+    pwmPeriod[1] = c >> 16;
+    delay6Cycles();
+    EEPROM_EEOFFSET_R = 5;
+    enttec = EEPROM_EERDWR_R == 1;
+    delay6Cycles();
+    EEPROM_EEOFFSET_R = 6;
+    c = EEPROM_EERDWR_R;
+    if (c >= 9600 && c <= 2500000 && c != CONSOLE_BAUD)
+    {
+        setBaudUart0(c);
+    }
+    configPwm();
+}
+
+/**
+ * @brief
+ *
+ * Function to apply the PWM clock and generator periods. The 8-bit personality keeps the PWM clock at 40 MHz / 16 so
+ * generator 2 can still run the 50 Hz servo period. The 16-bit personality runs the PWM clock at 40 MHz, so a
+ * 65535 count period gives full 16-bit resolution at 610 Hz.
+ */
+void configPwm()
+{
+
+    uint8_t o;
+
+    PWM1_2_CTL_R = 0;
+    PWM1_3_CTL_R = 0;
+    if (personality)
+    {
+        SYSCTL_RCC_R &= ~SYSCTL_RCC_USEPWMDIV;
+    }
+    else
+    {
+        SYSCTL_RCC_R |= SYSCTL_RCC_USEPWMDIV | SYSCTL_RCC_PWMDIV_16;
+    }
+    PWM1_2_LOAD_R = pwmPeriod[0];
+    PWM1_3_LOAD_R = pwmPeriod[1];
+    for (o = 0; o < 3; ++o)
+    {
+        buildCurve(o);
+    }
+    PWM1_2_CTL_R = PWM_2_CTL_ENABLE;
+    PWM1_3_CTL_R = PWM_3_CTL_ENABLE;
+}
+
+/**
+ * @brief
+ *
+ * Function to get the PWM compare value of a coarse and fine slot pair. The dimmer curve is interpolated between the
+ * coarse levels by the fine slot.
+ */
+uint16_t compare16(uint8_t o /**< [in] output, 0: Red, 1: Green, 2: Blue */, const uint8_t* slots /**< [in] coarse and fine slots */)
+{
+
+    const uint16_t* curve = curves[outputCurve[o]];
+    uint32_t q = curve[slots[0]];
+
+    if (slots[0] < 255)
+    {
+        q += ((curve[slots[0] + 1] - q) * slots[1]) >> 8;
+    }
+    q = (q * (pwmPeriod[o ? 1 : 0] - 1) + 32768) >> 16;
+
+    //like buildCurve, a level above 0 never maps to 0
+    if (q == 0 && (slots[0] || slots[1]))
+    {
+        q = 1;
+    }
+    return q;
+}
+
+/**
+ * @brief
+ *
+ * Function to build the compare table of a PWM output from its dimmer curve. Levels above 0 never map to 0, so the
+ * bottom of a fade does not go dark early.
+ */
+void buildCurve(uint8_t o /**< [in] output, 0: Red, 1: Green, 2: Blue */)
+{
+
+    const uint16_t* curve = curves[outputCurve[o]];
+    uint16_t l;
+
+    for (l = 0; l < 256; ++l)
+    {
+        outputCompare[o][l] = ((uint32_t) curve[l] * (pwmPeriod[o ? 1 : 0] - 1) + 32768) >> 16;
+        if (l > 0 && outputCompare[o][l] == 0)
+        {
+            outputCompare[o][l] = 1;
+        }
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to write to EEPROM to set address
+ */
+void EEWRITE(uint16_t B /**< [in] block address */, uint16_t offSet /**< [in] offset address */, uint32_t val /**< [in]value to write */)
+{
+
+    EEPROM_EEBLOCK_R = B;
+    EEPROM_EEOFFSET_R = offSet;
+    EEPROM_EERDWR_R = val;
+}
+
+/**
+ * @brief
+ *
+ * Function to clear DMX data bins of a universe. Fades running on it are cancelled so they do not bring levels back.
+ */
+void clearDMX(uint8_t u /**< [in] universe index */)
+{
+
+    uint16_t i = 0;
+    beginDMXWrite(u);
+    stopFades(u, 0, 511);
+    for (i = 0; i < 512; ++i)
+    {
+        ports[u].back[i] = 0;
+    }
+    endDMXWrite(u);
+}
+
+/**
+ * @brief
+ *
+ * Function to hash a command name into the command hash table
+ */
+uint8_t hashCommand(const char* name /**< [in] command name */)
+{
+
+    uint16_t h = 0;
+
+    while (*name)
+    {
+        h = h * 31 + *name++;
+    }
+    return h & (COMMAND_HASH - 1);
+}
+
+/**
+ * @brief
+ *
+ * Function to build the command hash table from commandNames, with linear probing on collisions
+ */
+void buildCommandHash()
+{
+
+    uint8_t i, h;
+
+    memset(commandHash, 0, sizeof(commandHash));
+    for (i = 1; i <= COMMANDS; ++i)
+    {
+        h = hashCommand(commandNames[i]);
+        while (commandHash[h])
+        {
+            h = (h + 1) & (COMMAND_HASH - 1);
+        }
+        commandHash[h] = i;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to look up a command. The table is mostly empty, so this is one hash and usually one strcmp however
+ * many commands there are. Returns the CMD_ number, or 0 for an unknown command.
+ */
+uint8_t findCommand(const char* name /**< [in] command name */)
+{
+
+    uint8_t h = hashCommand(name);
+
+    while (commandHash[h])
+    {
+        if (strcmp(commandNames[commandHash[h]], name) == 0)
+        {
+            return commandHash[h];
+        }
+        h = (h + 1) & (COMMAND_HASH - 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to set a run of slots to one level, a word at a time between the unaligned ends
+ */
+void fillSlots(uint8_t* d /**< [in] first slot */, uint16_t n /**< [in] number of slots */, uint8_t v /**< [in] level */)
+{
+
+    uint32_t word = v * 0x01010101u;
+
+    while (n && ((uint32_t) d & 3))
+    {
+        *d++ = v;
+        --n;
+    }
+    while (n >= 4)
+    {
+        *(uint32_t*) d = word;
+        d += 4;
+        n -= 4;
+    }
+    while (n--)
+    {
+        *d++ = v;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to cancel the fades of a range of channels so a write to them is not faded over. Only universe 1 fades.
+ */
+void stopFades(uint8_t u /**< [in] universe index */, uint16_t first /**< [in] first channel, 0 based */,
+        uint16_t last /**< [in] last channel, 0 based */)
+{
+
+    uint16_t ch;
+
+    if (u != 0)
+    {
+        return;
+    }
+    maskEffects();
+    for (ch = first; ch <= last; ++ch)
+    {
+        fadeActive[ch >> 5] &= ~(1u << (ch & 31));
+    }
+    unmaskEffects();
+}
+
+/**
+ * @brief
+ *
+ * Function to parse an address of the form [universe:]address. Universe defaults to 1.
+ * Returns the address and stores the universe index, or DMX_PORTS if the universe is invalid.
+ */
+uint16_t parseAddress(char* arg /**< [in] argument to parse */, uint8_t* u /**< [out] universe index */)
+{
+
+    char* colon = strchr(arg, ':');
+    uint16_t universe = 1;
+
+    if (colon != NULL)
+    {
+        universe = atoi(arg);
+        arg = colon + 1;
+    }
+    *u = (universe > 0 && universe <= DMX_PORTS) ? universe - 1 : DMX_PORTS;
+    return atoi(arg);
+}
+
+/**
+ * @brief
+ *
+ * Function to parse commands from UART0 and execute functions or set flags.
+ */
+uint8_t parseCommand()
+{
+
+    //commands that work the same in controller and device mode
+    switch (findCommand(command))
+    {
+        case CMD_ENTTEC:
+        {
+            enttec = atoi(arg1) == 1;
+            EEWRITE(2, 5, enttec);
+            putsUart0(enttec ? "\n\rEnttec USB Pro packets on" : "\n\rEnttec USB Pro packets off");
+            return 0;
+        }
+        case CMD_BAUD:
+        {
+            uint32_t baud = strtoul(arg1, NULL, 10);
+            if (baud >= 9600 && baud <= 2500000)
+            {
+                putsUart0("\n\rConsole baud rate: ");
+                putsUart0(longToChar(baud));
+                putsUart0("\n\r");
+                EEWRITE(2, 6, baud);
+                setBaudUart0(baud);
+            }
+            else
+            {
+                putsUart0("\n\rBaud rate 9600 to 2500000 only.\n\r");
+            }
+            return 0;
+        }
+    default:
+        break;
+    }
+
+    if (mode == 1)
+    { //controller mode
+        switch (findCommand(command))
+        {
+        case CMD_DEVICE:
+        {
+            TIMER1_CTL_R |= TIMER_CTL_TAEN;
+            txUartMode = 0xFF;
+            configRxUart();
+
+            putsUart0("\n\rDevice Mode\n\r");
+            mode = 0;
+            EEWRITE(0, 2, 0);
+            return 0;
+        }
+        case CMD_SECONDS:
+        {
+            putsUart0("\n\rSetting:");
+            putsUart0("\n\r Seconds:");
+
+            putsUart0(arg1);
+            secondsTrigger = atoi(arg1);
+            return 0;
+        }
+        case CMD_STARTEND:
+        {
+            putsUart0("\n\rSetting:");
+            putsUart0("\n\r Start:");
+
+            putsUart0(arg1);
+            dimStart = atoi(arg1);
+            putsUart0("\n\rSetting:");
+            putsUart0("\n\r End:");
+
+            putsUart0(arg2);
+            dimEnd = atoi(arg2);
+            return 0;
+        }
+        case CMD_WOO:
+        {
+            if (woo == 2)
+            {
+                generators[0].wave = 0;
+            }
+            woo = atoi(arg1);
+            if (woo == 1)
+            {
+                putsUart0("\r\nAll Addresses 255 :)\r\n");
+            }
+            else if (woo == 2 && deviceModeAddress > 0 && deviceModeAddress < 511)
+            {
+                //RGB ramp: triangles a third of a cycle apart, about 2 levels per frame
+                generators[0].first = deviceModeAddress - 1;
+                generators[0].last = deviceModeAddress + 1;
+                generators[0].phase = 0;
+                generators[0].rate = 258;
+                generators[0].spread = 21845;
+                generators[0].amplitude = 256;
+                generators[0].wave = waveTriangle;
+                putsUart0("\r\nRamp Animation :D\r\n");
+            }
+            else if (woo == 2)
+            {
+                //the ramp drives the address and the two after it
+                woo = 0;
+                putsUart0("\r\nwoo 2 needs a device address from 1 to 510.\r\n");
+            }
+            else if (woo == 3)
+            {
+                putsUart0("\r\nServo Set :D\r\n");
+            }
+            else if (woo == 4)
+            {
+                putsUart0("\r\nServo Sweep :D\r\n");
+            }
+            else if (woo == 5)
+            {
+                putsUart0("\r\nRamping\r\n");
+                putsUart0("\n\r Start:");
+
+                putsUart0(intToChar(dimStart));
+
+                putsUart0("\n\rSetting:");
+                putsUart0("\n\r End:");
+
+                putsUart0(intToChar(dimEnd));
+                beginDMXWrite(0);
+                dmxData[deviceModeAddress - 1] = dimStart;
+                endDMXWrite(0);
+                startFade(deviceModeAddress - 1, deviceModeAddress - 1, dimEnd,
+                          secondsTrigger * 1000);
+            }
+            else
+            {
+                putsUart0("\r\nNo Woo :(\r\n");
+            }
+            return 0;
+        }
+        case CMD_CLEAR:
+        {
+            uint8_t u = 0;
+            if (arg1[0] != '\0')
+            {
+                u = atoi(arg1) - 1;
+            }
+            if (u < DMX_PORTS)
+            {
+                clearDMX(u);
+                putsUart0("\n\rCleared.\n\r");
+            }
+            else
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            return 0;
+        }
+
+        case CMD_SET:
+        {
+            uint8_t u;
+            uint16_t addr = parseAddress(arg1, &u);
+            uint32_t value = strtoul(arg2, NULL, 10);
+            if (u >= DMX_PORTS)
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            else if (value > 255)
+            {
+                putsUart0("\n\rValues from 0 to 255 only.\n\r");
+            }
+            else if (addr > 0 && addr < 513)
+            {
+                putsUart0("\n\rSetting:");
+                putsUart0("\n\r Universe:");
+                putsUart0(longToChar(u + 1));
+                putsUart0("\n\r Address:");
+                putsUart0(intToChar(addr));
+                putsUart0("\n\r Value:");
+                putsUart0(arg2);
+                beginDMXWrite(u);
+                ports[u].back[addr - 1] = value;
+                stopFades(u, addr - 1, addr - 1);
+                endDMXWrite(u);
+            }
+
+            else
+            {
+                putsUart0("\n\rAddresses from 1 to 512 only.\n\r");
+            }
+
+            return 0;
+        }
+        case CMD_GET:
+        {
+            uint8_t u;
+            uint16_t addr = parseAddress(arg1, &u);
+            putsUart0("\n\rGetting:");
+            putsUart0("\n\rAddress:");
+            putsUart0(arg1);
+            putsUart0("\n\rValue:");
+            if (u >= DMX_PORTS)
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            else if (addr > 0 && addr < 513)
+                putsUart0(intToChar(ports[u].front[addr - 1]));
+            else
+                putsUart0("\n\rAddresses from 1 to 512 only.\n\r");
+
+            return 0;
+        }
+
+        case CMD_MAX:
+        {
+            uint8_t u;
+            uint16_t max = parseAddress(arg1, &u);
+            if (u >= DMX_PORTS)
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            else if (max > 0 && max < 513)
+            {
+                putsUart0("\n\rSetting Max to ");
+                putsUart0(longToChar(max));
+                ports[u].maxSlots = max;
+                if (max < 512)
+                {
+                    //channels past the new maximum are not sent, a fade there would finish unseen
+                    stopFades(u, max, 511);
+                }
+            }
+            else
+            {
+                putsUart0("\n\rAddresses from 1 to 512 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_FILL:
+        {
+            uint8_t u;
+            uint16_t first = parseAddress(arg1, &u);
+            uint16_t last = atoi(arg2);
+            uint32_t value = strtoul(arg3, NULL, 10);
+            if (u >= DMX_PORTS)
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            else if (value > 255)
+            {
+                putsUart0("\n\rValues from 0 to 255 only.\n\r");
+            }
+            else if (first > 0 && first <= last && last < 513)
+            {
+                beginDMXWrite(u);
+                fillSlots(ports[u].back + first - 1, last - first + 1, value);
+                stopFades(u, first - 1, last - 1);
+                endDMXWrite(u);
+                putsUart0("\n\rFilled ");
+                putsUart0(longToChar(last - first + 1));
+                putsUart0(" slots");
+            }
+            else
+            {
+                putsUart0("\n\rfill [universe:]<first>,<last>,<value> with addresses from 1 to 512 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_COPY:
+        {
+            uint8_t u, v;
+            uint16_t src = parseAddress(arg1, &u);
+            uint16_t dst = parseAddress(arg2, &v);
+            uint16_t len = atoi(arg3);
+            if (u >= DMX_PORTS || v >= DMX_PORTS)
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            else if (src > 0 && dst > 0 && len > 0 && src + len <= 513 && dst + len <= 513)
+            {
+                beginDMXWrite(u);
+                beginDMXWrite(v);
+                memmove(ports[v].back + dst - 1, ports[u].back + src - 1, len);
+                stopFades(v, dst - 1, dst + len - 2);
+                endDMXWrite(v);
+                endDMXWrite(u);
+                putsUart0("\n\rCopied ");
+                putsUart0(longToChar(len));
+                putsUart0(" slots");
+            }
+            else
+            {
+                putsUart0("\n\rcopy [universe:]<source>,[universe:]<destination>,<length> within 512 slots only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_RAMP:
+        {
+            uint8_t u;
+            uint16_t first = parseAddress(arg1, &u);
+            uint16_t last = atoi(arg2);
+            uint16_t from = atoi(arg3);
+            uint16_t to = atoi(arg4);
+            if (u >= DMX_PORTS)
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            else if (first > 0 && first <= last && last < 513 && from < 256 && to < 256)
+            {
+                //Q16 level stepped once per slot
+                int32_t level = from << 16;
+                int32_t step = last > first ? (((int32_t) to - from) << 16) / (last - first) : 0;
+                uint8_t* d = ports[u].back + first - 1;
+                uint16_t n;
+                beginDMXWrite(u);
+                for (n = last - first + 1; n; --n)
+                {
+                    *d++ = (level + 32768) >> 16;
+                    level += step;
+                }
+                stopFades(u, first - 1, last - 1);
+                endDMXWrite(u);
+                putsUart0("\n\rRamped ");
+                putsUart0(longToChar(last - first + 1));
+                putsUart0(" slots");
+            }
+            else
+            {
+                putsUart0("\n\rramp [universe:]<first>,<last>,<from 0 to 255>,<to 0 to 255> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_PATTERN:
+        {
+            uint8_t u;
+            uint16_t first = parseAddress(arg1, &u);
+            uint16_t last = atoi(arg2);
+            uint16_t len = atoi(arg3);
+            if (u >= DMX_PORTS)
+            {
+                putsUart0("\n\rUniverses from 1 to 6 only.\n\r");
+            }
+            else if (first > 0 && first <= last && last < 513 && len > 0)
+            {
+                //repeat the first len slots by doubling the copied run, so a whole universe is a few memcpy calls
+                uint8_t* d = ports[u].back + first - 1;
+                uint16_t n = last - first + 1;
+                uint16_t done = len < n ? len : n;
+                beginDMXWrite(u);
+                while (done < n)
+                {
+                    uint16_t chunk = done < n - done ? done : n - done;
+                    memcpy(d + done, d, chunk);
+                    done += chunk;
+                }
+                stopFades(u, first - 1, last - 1);
+                endDMXWrite(u);
+                putsUart0("\n\rRepeated ");
+                putsUart0(longToChar(len));
+                putsUart0(" slots to ");
+                putsUart0(longToChar(last));
+            }
+            else
+            {
+                putsUart0("\n\rpattern [universe:]<first>,<last>,<slots to repeat> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_UNIVERSE:
+        {
+            uint8_t u = atoi(arg1);
+            if (u > 1 && u <= DMX_PORTS)
+            {
+                //takes effect at the next break, a port never starts mid frame
+                ports[u - 1].enabled = atoi(arg2) != 0;
+                putsUart0("\n\rUniverse ");
+                putsUart0(longToChar(u));
+                putsUart0(ports[u - 1].enabled ? " on" : " off");
+            }
+            else
+            {
+                putsUart0("\n\rUniverses from 2 to 6 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_FADE:
+        {
+            uint16_t first = atoi(arg1);
+            uint16_t last = atoi(arg2);
+            uint16_t value = atoi(arg3);
+            uint32_t ms = atoi(arg4);
+            if (first > 0 && first <= last && last < 513 && value < 256)
+            {
+                startFade(first - 1, last - 1, value, ms);
+                putsUart0("\n\rFading ");
+                putsUart0(longToChar(first));
+                putsUart0(" to ");
+                putsUart0(longToChar(last));
+                putsUart0(" to ");
+                putsUart0(longToChar(value));
+                putsUart0(" in ");
+                putsUart0(longToChar(ms));
+                putsUart0(" ms");
+            }
+            else
+            {
+                putsUart0("\n\rfade <first>,<last>,<value>,<ms> with addresses from 1 to 512 and values to 255 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_EFFECTS:
+        {
+            uint8_t i;
+            uint16_t count = 0;
+            uint32_t active;
+            for (i = 0; i < 16; ++i)
+            {
+                for (active = fadeActive[i]; active != 0; active &= active - 1)
+                {
+                    count++;
+                }
+            }
+            putsUart0("\n\rFading channels: ");
+            putsUart0(longToChar(count));
+            putsUart0("\n\rCycles per frame: ");
+            putsUart0(longToChar(effectCycles));
+            putsUart0("\n\rMax cycles per frame: ");
+            putsUart0(longToChar(effectMax));
+            putsUart0("\n\rOverruns: ");
+            putsUart0(longToChar(effectOverruns));
+            return 0;
+        }
+        case CMD_GEN:
+        {
+            uint8_t g = atoi(arg1);
+            uint8_t w = atoi(arg2);
+            uint16_t first = atoi(arg3);
+            uint16_t last = atoi(arg4);
+            if (g < GENERATORS && w < 7 && first > 0 && first <= last && last < 513)
+            {
+                generators[g].wave = 0;
+                generators[g].first = first - 1;
+                generators[g].last = last - 1;
+                generators[g].phase = 0;
+                if (generators[g].amplitude == 0)
+                {
+                    generators[g].rate = 256;
+                    generators[g].spread = 0;
+                    generators[g].amplitude = 256;
+                }
+                generators[g].wave = waves[w];
+                putsUart0("\n\rGenerator ");
+                putsUart0(longToChar(g));
+                putsUart0(w ? " on" : " off");
+            }
+            else
+            {
+                putsUart0("\n\rgen <0 to 7>,<waveform 0 to 6>,<first address>,<last address> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_GENP:
+        {
+            uint8_t g = atoi(arg1);
+            uint16_t amplitude = atoi(arg4);
+            if (g < GENERATORS && amplitude <= 256)
+            {
+                generators[g].rate = atoi(arg2);
+                generators[g].spread = atoi(arg3);
+                generators[g].amplitude = amplitude;
+                putsUart0("\n\rGenerator ");
+                putsUart0(longToChar(g));
+                putsUart0(" rate ");
+                putsUart0(longToChar(generators[g].rate));
+                putsUart0(" spread ");
+                putsUart0(longToChar(generators[g].spread));
+                putsUart0(" amplitude ");
+                putsUart0(longToChar(generators[g].amplitude));
+            }
+            else
+            {
+                putsUart0("\n\rgenp <0 to 7>,<rate>,<spread>,<amplitude 0 to 256> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_RECORD:
+        {
+            uint8_t n = atoi(arg1);
+            if (n < SCENES)
+            {
+                recordScene(n, dmxFront);
+                putsUart0("\n\rRecorded scene ");
+                putsUart0(longToChar(n));
+            }
+            else
+            {
+                putsUart0("\n\rScenes from 0 to 47 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_CUE:
+        {
+            uint8_t n = atoi(arg1);
+            uint8_t scene = atoi(arg2);
+            if (n < CUES && scene < SCENES)
+            {
+                cues[n].scene = scene;
+                cues[n].used = 1;
+                cues[n].fadeIn = atoi(arg3) / 10;
+                cues[n].fadeOut = atoi(arg4) / 10;
+                if (cues[n].wait == 0xFFFF)
+                {
+                    cues[n].wait = 0;
+                }
+                saveCues();
+                putsUart0("\n\rCue ");
+                putsUart0(longToChar(n));
+                putsUart0(" scene ");
+                putsUart0(longToChar(scene));
+            }
+            else
+            {
+                putsUart0("\n\rcue <0 to 127>,<scene 0 to 47>,<fade in ms>,<fade out ms> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_WAIT:
+        {
+            uint8_t n = atoi(arg1);
+            if (n < CUES && cues[n].used == 1)
+            {
+                cues[n].wait = atoi(arg2) / 10;
+                saveCues();
+                putsUart0("\n\rCue ");
+                putsUart0(longToChar(n));
+                putsUart0(" follows after ");
+                putsUart0(longToChar(cues[n].wait * 10));
+                putsUart0(" ms");
+            }
+            else
+            {
+                putsUart0("\n\rwait <programmed cue>,<ms, 0 to wait for go> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_GO:
+        {
+            //without a cue number, go to the next cue
+            cueRequest = arg1[0] != '\0' ? atoi(arg1) : (playing ? cueCurrent + 1 : cueCurrent);
+            putsUart0("\n\rGo cue ");
+            putsUart0(longToChar(cueRequest));
+            return 0;
+        }
+        case CMD_STOP:
+        {
+            playing = 0;
+            cueRequest = -1;
+            putsUart0("\n\rPlayback stopped");
+            return 0;
+        }
+        case CMD_LOAD:
+        {
+            playing = 0;
+            cueRequest = -1;
+            loadPos = 0;
+            loadSum = 0;
+            loadScenes = 0;
+            loadCues = 0;
+            memset(loadScene, 0, sizeof(loadScene));
+            loading = 1;
+            putsUart0("\n\rWaiting for show image");
+            return 0;
+        }
+        case CMD_TXMODE:
+        {
+            uint8_t m = atoi(arg1);
+            if (m <= 2)
+            {
+                txMode = m;
+                putsUart0("\n\rTransmit Mode: ");
+                if (txMode == 1)
+                    putsUart0("uDMA");
+                else if (txMode == 2)
+                    putsUart0("FIFO refill");
+                else
+                    putsUart0("Interrupt per slot");
+            }
+            else
+            {
+                putsUart0("\n\rTransmit modes 0 to 2 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_BREAK:
+        {
+            uint32_t us = strtoul(arg1, NULL, 10);
+            if (us >= 92 && us <= BREAK_MAX)
+            {
+                breakTime = us;
+                putsUart0("\n\rBreak set to ");
+                putsUart0(longToChar(breakTime));
+                putsUart0(" us");
+            }
+            else
+            {
+                putsUart0("\n\rBreak must be 92 to 10000 us.\n\r");
+            }
+            return 0;
+        }
+        case CMD_MAB:
+        {
+            uint32_t us = strtoul(arg1, NULL, 10);
+            if (us >= 12 && us <= MAB_MAX)
+            {
+                mabTime = us;
+                putsUart0("\n\rMark after break set to ");
+                putsUart0(longToChar(mabTime));
+                putsUart0(" us");
+            }
+            else
+            {
+                putsUart0("\n\rMark after break must be 12 to 10000 us.\n\r");
+            }
+            return 0;
+        }
+        case CMD_RATE:
+        {
+            refreshRate = atoi(arg1);
+            putsUart0("\n\rRefresh rate set to ");
+            if (refreshRate > 0)
+            {
+                putsUart0(longToChar(refreshRate));
+                putsUart0(" Hz");
+            }
+            else
+            {
+                putsUart0("maximum");
+            }
+            return 0;
+        }
+        case CMD_AUTOSLOTS:
+        {
+            autoSlots = atoi(arg1) != 0;
+            putsUart0(autoSlots ? "\n\rTrimming frames to highest non-zero address\n\r" : "\n\rSending max addresses\n\r");
+            return 0;
+        }
+        case CMD_FPS:
+        {
+            putsUart0("\n\rFrames per second: ");
+            putsUart0(longToChar(achievedFps));
+            putsUart0("\n\rWorst case jitter (us): ");
+            putsUart0(longToChar(frameJitter / 40));
+            putsUart0("\n\rSlots: ");
+            putsUart0(longToChar(txSlots));
+            putsUart0("\n\rIdle gap (us): ");
+            putsUart0(longToChar(txGap));
+            return 0;
+        }
+        case CMD_TXSTAT:
+        {
+            putsUart0("\n\rFrames: ");
+            putsUart0(longToChar(txFrames));
+            putsUart0("\n\rInterrupts per frame: ");
+            putsUart0(longToChar(txIsrPerFrame));
+            printConsoleStats();
+            return 0;
+        }
+        case CMD_ON:
+        {
+            putsUart0("\n\rContinuous On\n\r");
+            continuous = 1;
+            lastBreakValid = 0;
+            GPIO_PORTC_DATA_R = 0x40;
+            TIMER1_CTL_R |= TIMER_CTL_TAEN;
+            return 0;
+        }
+        case CMD_OFF:
+        {
+            putsUart0("\n\rContinuous off\n\r");
+            continuous = 0;
+            if (DMXMode < 3)
+            {
+                //stopped during break or mark after break, release the lines
+                uint8_t i;
+                for (i = 0; i < DMX_PORTS; ++i)
+                {
+                    UART_REG(ports[i].base, UART_O_LCRH) &= ~UART_LCRH_BRK;
+                }
+                DMXMode = 0;
+            }
+            return 0;
+        }
+        case CMD_CONTROLLER:
+        {
+            UART1_IM_R = UART_IM_TXIM;
+            putsUart0("\n\rAlready in Controller Mode\n\r");
+
+            return 0;
+        }
+        default:
+        {
+            putsUart0("\n\rInvalid Controller Mode Command\r\n");
+            printCommandList();
+            return 0;
+        }
+        }
+    }
+
+    //device Mode
+    else if (mode == 0)
+    {
+        switch (findCommand(command))
+        {
+        case CMD_RXMODE:
+        {
+            uint8_t m = atoi(arg1);
+            if (m == 1 && repeat)
+            {
+                putsUart0("\n\rRepeater needs receive mode 0.\n\r");
+            }
+            else if (m <= 1)
+            {
+                rxMode = m;
+                configRxUart();
+                putsUart0("\n\rReceive Mode: ");
+                if (rxMode == 1)
+                    putsUart0("uDMA");
+                else
+                    putsUart0("Interrupt per slot");
+            }
+            else
+            {
+                putsUart0("\n\rReceive modes 0 to 1 only.\n\r");
+            }
             return 0;
         }
-        if (strcmp(command, "seconds") == 0)
+        case CMD_REPEAT:
         {
-            putsUart0("\n\rSetting:");
-            putsUart0("\n\r Seconds:");
-
-            putsUart0(arg1);
-            secondsTrigger = atoi(arg1);
+            uint8_t i;
+            repeat = atoi(arg1) != 0;
+            if (repeat && merge)
+            {
+                merge = 0;
+                configMergeUart();
+            }
+            stopRepeater();
+            if (repeat)
+            {
+                //slots are forwarded one at a time, so the receiver must see each one
+                rxMode = 0;
+                repMaxSlotLatency = 0;
+                for (i = 1; i < DMX_PORTS; ++i)
+                {
+                    UART_REG(ports[i].base, UART_O_CTL) &= ~UART_CTL_EOT;
+                }
+            }
+            configRxUart();
+            putsUart0(repeat ? "\n\rRepeating to universes 2 to 6" : "\n\rRepeater off");
             return 0;
         }
-        if (strcmp(command, "startend") == 0)
+        case CMD_MERGE:
         {
-            putsUart0("\n\rSetting:");
-            putsUart0("\n\r Start:");
-
+            uint8_t m = atoi(arg1);
+            uint8_t i;
+            if (m <= 2)
+            {
+                merge = m;
+                repeat = 0;
+                stopRepeater();
+                mergeState = 0;
+                for (i = 1; i < DMX_PORTS; ++i)
+                {
+                    UART_REG(ports[i].base, UART_O_CTL) &= ~UART_CTL_EOT;
+                }
+                configMergeUart();
+                putsUart0(merge == 1 ? "\n\rMerging HTP" : merge == 2 ? "\n\rMerging LTP" : "\n\rMerge off");
+                configRxUart();
+            }
+            else
+            {
+                putsUart0("\n\rMerge modes 0 to 2 only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_STATS:
+        {
+            uint8_t i;
+            putsUart0("\n\rfps ");
+            putsUart0(longToChar(rxStats.fps));
+            putsUart0(" slots ");
+            putsUart0(longToChar(rxStats.slots));
+            putsUart0(" period ");
+            putsUart0(longToChar(rxStats.period / 40));
+            putsUart0("us brk ");
+            putsUart0(longToChar(rxStats.breakTicks / 40));
+            putsUart0("us mab ");
+            putsUart0(longToChar(rxStats.mabTicks / 40));
+            putsUart0("us last ");
+            if (rxStats.frames > 0)
+            {
+                putsUart0(longToChar((TIMESTAMP - rxStats.lastGood) / 40000));
+                putsUart0("ms");
+            }
+            else
+            {
+                putsUart0("never");
+            }
+            putsUart0("\n\rframes ");
+            putsUart0(longToChar(rxStats.frames));
+            putsUart0(" drop ");
+            putsUart0(longToChar(rxStats.dropped));
+            putsUart0(" brk ");
+            putsUart0(longToChar(rxStats.breaks));
+            putsUart0(" fe ");
+            putsUart0(longToChar(rxStats.framingErrors));
+            putsUart0(" oe ");
+            putsUart0(longToChar(rxStats.overruns));
+            putsUart0(" sc ");
+            putsUart0(longToChar(rxStats.startCodes));
+            putsUart0(" bad ");
+            putsUart0(longToChar(rxStats.badBreaks));
+            putsUart0(" isr ");
+            putsUart0(longToChar(rxIsrPerFrame));
+            if (repeat)
+            {
+                putsUart0("\n\rrepeat brk ");
+                putsUart0(longToChar(repBreakLatency / 40));
+                putsUart0("us slot ");
+                putsUart0(longToChar(repSlotLatency / 40));
+                putsUart0("us max ");
+                putsUart0(longToChar(repMaxSlotLatency / 40));
+                putsUart0("us");
+            }
+            if (merge)
+            {
+                putsUart0("\n\rmerge B frames ");
+                putsUart0(longToChar(mergeFramesB));
+                putsUart0(" slots ");
+                putsUart0(longToChar(mergeSlotsB));
+                putsUart0(" out ");
+                putsUart0(longToChar(mergeSlots));
+                putsUart0(" took ");
+                putsUart0(longToChar(mergeTicks / 40));
+                putsUart0("us");
+            }
+            putsUart0("\n\rslots/64");
+            for (i = 0; i < 8; ++i)
+            {
+                putsUart0(" ");
+                putsUart0(longToChar(rxStats.histogram[i]));
+            }
+            printConsoleStats();
+            return 0;
+        }
+        case CMD_ADDRESS:
+        {
+            uint16_t a = atoi(arg1);
+            //the 16-bit personality reads 6 slots from the address
+            if (a < 1 || a > (personality ? 507 : 512))
+            {
+                putsUart0(personality ? "\n\rAddresses from 1 to 507 only with the 16-bit personality.\n\r"
+                        : "\n\rAddresses from 1 to 512 only.\n\r");
+                return 0;
+            }
+            putsUart0("\n\rDevice address set to: ");
             putsUart0(arg1);
-            dimStart = atoi(arg1);
-            putsUart0("\n\rSetting:");
-            putsUart0("\n\r End:");
-
-            putsUart0(arg2);
-            dimEnd = atoi(arg2);
+            deviceModeAddress = a;
+            EEWRITE(1, 2, deviceModeAddress);
             return 0;
         }
-        else if (strcmp(command, "woo") == 0)
+        case CMD_PERSONALITY:
         {
-            woo = atoi(arg1);
-            if (woo == 1)
+            uint8_t p = atoi(arg1);
+            if (p == 1 && deviceModeAddress > 507)
             {
-                putsUart0("\r\nAll Addresses 255 :)\r\n");
+                putsUart0("\n\rThe 16-bit personality needs an address from 1 to 507.\n\r");
             }
-            else if (woo == 2)
+            else if (p <= 1)
             {
-                putsUart0("\r\nRamp Animation :D\r\n");
+                personality = p;
+                pwmPeriod[0] = pwmPeriod[1] = p ? PWM_PERIOD_16 : PWM_PERIOD;
+                configPwm();
+                EEWRITE(2, 3, personality);
+                EEWRITE(2, 4, pwmPeriod[0] | ((uint32_t) pwmPeriod[1] << 16));
+                putsUart0(p ? "\n\r16-bit personality, 6 slots" : "\n\r8-bit personality, 3 slots");
             }
-            else if (woo == 3)
+            else
             {
-                putsUart0("\r\nServo Set :D\r\n");
+                putsUart0("\n\rpersonality < 0 for 8-bit | 1 for 16-bit > only.\n\r");
             }
-            else if (woo == 4)
+            return 0;
+        }
+        case CMD_PERIOD:
+        {
+            uint8_t g = atoi(arg1);
+            uint32_t counts = atoi(arg2);
+            if ((g == 2 || g == 3) && counts >= 256 && counts <= 65535)
             {
-                putsUart0("\r\nServo Sweep :D\r\n");
+                pwmPeriod[g - 2] = counts;
+                configPwm();
+                EEWRITE(2, 4, pwmPeriod[0] | ((uint32_t) pwmPeriod[1] << 16));
+                putsUart0("\n\rGenerator ");
+                putsUart0(longToChar(g));
+                putsUart0(" period ");
+                putsUart0(longToChar(counts));
             }
-            else if (woo == 5)
+            else
             {
-                TIMER2_CTL_R |= TIMER_CTL_TAEN;
-                putsUart0("\r\nRamping\r\n");
-                putsUart0("\n\r Start:");
-
-                putsUart0(intToChar(dimStart));
-
-                putsUart0("\n\rSetting:");
-                putsUart0("\n\r End:");
-
-                putsUart0(intToChar(dimEnd));
-                dimValue = dimStart;
+                putsUart0("\n\rperiod <2 for red | 3 for green, blue>,<256 to 65535 PWM clocks> only.\n\r");
+            }
+            return 0;
+        }
+        case CMD_CURVE:
+        {
+            uint8_t o = atoi(arg1);
+            uint8_t c = atoi(arg2);
+            if (o >= 1 && o <= 3 && c < 4)
+            {
+                outputCurve[o - 1] = c;
+                buildCurve(o - 1);
+                EEWRITE(2, 2, outputCurve[0] | (outputCurve[1] << 2) | (outputCurve[2] << 4));
+                putsUart0("\n\rOutput ");
+                putsUart0(longToChar(o));
+                putsUart0(" curve ");
+                putsUart0(longToChar(c));
             }
             else
             {
-                putsUart0("\r\nNo Woo :(\r\n");
+                putsUart0("\n\rcurve <1 to 3 for red, green, blue>,<0 linear | 1 square | 2 gamma 2.2 | 3 S-curve> only.\n\r");
             }
             return 0;
         }
-        else if (strcmp(command, "clear") == 0)
+        case CMD_DEVICE:
+        {
+            configRxUart();
+            TIMER1_CTL_R |= TIMER_CTL_TAEN;
+            putsUart0("\n\rAlready in Device Mode\n\r");
+            return 0;
+        }
+        case CMD_CONTROLLER:
+        {
+            UART1_IM_R = UART_IM_TXIM;
+            UDMA_ENACLR_R = 1 << UDMA_CH_UART1RX;
+            rxAbort();
+            GPIO_PORTC_DATA_R &= 0xDF;
+            txUartMode = 0xFF;
+            repeat = 0;
+            merge = 0;
+            stopRepeater();
+            configMergeUart();
+            putsUart0("\n\rController Mode\n\r");
+            mode = 1;
+            EEWRITE(0, 2, 1);
+            return 0;
+        }
+        default:
         {
+            putsUart0("\n\rInvalid Device Mode Command\n\r");
+            printCommandList();
+            return 0;
+        }
+        }
+    }
+    else
+    {
+        putsUart0("\n\rInvalid Mode\n\r");
+        return 1;
+    }
+}
 
-            clearDMX();
+/**
+ * @brief
+ *
+ * Function to clear command and argument arrays.
+ */
+void clearStr()
+{
 
-            putsUart0("\n\rCleared.\n\r");
-            return 0;
+    uint8_t i = 0;
+    for (; i < FIELD_SIZE; ++i)
+    {
+        command[i] = '\0';
+        arg1[i] = '\0';
+        arg2[i] = '\0';
+        arg3[i] = '\0';
+        arg4[i] = '\0';
+    }
+    pos = 0;
+    enteringField = 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to check if character is letter
+ */
+bool isLetter(char c /**< character to check */)
+{
+
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/**
+ * @brief
+ *
+ * Function to check if character is number
+ */
+bool isNumber(char c /**< character to check */)
+{
+
+    return (c >= '0' && c <= '9');
+}
+
+/**
+ * @brief
+ *
+ * Function to print available commands to user
+ */
+void printCommandList()
+{
+
+    putsUart0("\n\rAvailable Commands:\r\n");
+    putsUart0("For Device Mode:\r\n");
+    putsUart0("\tcontroller\n\r");
+    putsUart0("\taddress <address of device>\r\n");
+    putsUart0("\trxmode < 0 for interrupt per slot | 1 for uDMA >\r\n");
+    putsUart0("\trepeat < 0 for off | 1 to forward to universes 2 to 6 >\r\n");
+    putsUart0("\tmerge < 0 for off | 1 for HTP | 2 for LTP > (inputs UART1 and U7RX PE0, out on universes 2 to 5)\r\n");
+    putsUart0("\tstats\r\n");
+    putsUart0("\tenttec < 0 for off | 1 to send received frames as Enttec USB Pro packets >\r\n");
+    putsUart0("\tbaud <console baud rate 9600 to 2500000, kept in EEPROM>\r\n");
+    putsUart0("\tcurve <output 1 to 3>,<0 linear | 1 square | 2 gamma 2.2 | 3 S-curve>\r\n");
+    putsUart0("\tpersonality < 0 for 8-bit | 1 for 16-bit coarse/fine pairs > (servo sweeps need 8-bit)\r\n");
+    putsUart0("\tperiod <PWM generator 2 | 3>,<PWM clocks, 2.5 MHz for 8-bit, 40 MHz for 16-bit>\r\n");
+
+    putsUart0("For Controller Mode:\r\n");
+    putsUart0("\tdevice\r\n");
+    putsUart0("\tset [universe:]<address>,<value>\r\n");
+    putsUart0("\tfill [universe:]<first>,<last>,<value>\r\n");
+    putsUart0("\tcopy [universe:]<source>,[universe:]<destination>,<length>\r\n");
+    putsUart0("\tramp [universe:]<first>,<last>,<from>,<to>\r\n");
+    putsUart0("\tpattern [universe:]<first>,<last>,<slots to repeat>\r\n");
+    putsUart0("\tget [universe:]<address>,<value>\r\n");
+    putsUart0("\tclear [universe]\r\n");
+    putsUart0(
+            "\twoo < 0 for no woo :( \r\n\t    | 1 for all addresses 255 \r\n\t    | 2 for ramp animation >\r\n");
+    putsUart0(
+            "\twoo < 3 for servo angle set \r\n\t    | 4 for servo sweep \r\n\t    | 5 for special ramping function >\r\n");
+    putsUart0("\tmax [universe:]<number of addresses>\r\n");
+    putsUart0("\tfade <first address>,<last address>,<value>,<ms>\r\n");
+    putsUart0("\tgen <generator 0 to 7>,< 0 off | 1 sine | 2 triangle | 3 square | 4 saw | 5 random | 6 chase >,<first address>,<last address>\r\n");
+    putsUart0("\tgenp <generator>,<rate, 256 per table step>,<phase spread per address>,<amplitude 0 to 256> (whole range)\r\n");
+    putsUart0("\teffects\r\n");
+    putsUart0("\trecord <scene 0 to 47>\r\n");
+    putsUart0("\tcue <cue 0 to 127>,<scene>,<fade in ms>,<fade out ms>\r\n");
+    putsUart0("\twait <cue>,<ms before the next cue follows, 0 for go>\r\n");
+    putsUart0("\tgo [cue]\r\n");
+    putsUart0("\tstop\r\n");
+    putsUart0("\tload (show image from tools/showc.py)\r\n");
+    putsUart0("\tenttec < 0 for off | 1 to take Enttec USB Pro packets >\r\n");
+    putsUart0("\tbaud <console baud rate 9600 to 2500000, kept in EEPROM>\r\n");
+    putsUart0("\tuniverse <universe 2 to 6>,< 0 for off | 1 for on >\r\n");
+    putsUart0("\ttxmode < 0 for interrupt per slot | 1 for uDMA | 2 for FIFO refill >\r\n");
+    putsUart0("\ttxstat\r\n");
+    putsUart0("\tbreak <break in us, 92 to 10000>\r\n");
+    putsUart0("\tmab <mark after break in us, 12 to 10000>\r\n");
+    putsUart0("\trate <frames per second, 0 for maximum>\r\n");
+    putsUart0("\tautoslots < 0 for max addresses | 1 for highest non-zero address >\r\n");
+    putsUart0("\tfps\r\n");
+
+}
+
+/**
+ * @brief
+ *
+ * Function to wait for specified microseconds
+ */
+void waitMicrosecond(uint32_t us /**< time to wait in microseconds */)
+{
+
+    __asm("WMS_LOOP0:   MOV  R1, #6");
+    // 1
+    __asm("WMS_LOOP1:   SUB  R1, #1");
+    // 6
+    __asm("             CBZ  R1, WMS_DONE1");
+    // 5+1*3
+    __asm("             NOP");
+    // 5
+    __asm("             NOP");
+    // 5
+    __asm("             B    WMS_LOOP1");
+    // 5*2 (speculative, so P=1)
+    __asm("WMS_DONE1:   SUB  R0, #1");
+    // 1
+    __asm("             CBZ  R0, WMS_DONE0");
+    // 1
+    __asm("             NOP");
+    // 1
+    __asm("             B    WMS_LOOP0");
+    // 1*2 (speculative, so P=1)
+    __asm("WMS_DONE0:");
+    // ---
+    // 40 clocks/us + error
+}
+
+/**
+ * @brief
+ *
+ * Function to print console ring overflows and the longest UART0 interrupt
+ */
+void printConsoleStats()
+{
+
+    putsUart0("\n\rConsole overflows tx ");
+    putsUart0(longToChar(tx0Overflows));
+    putsUart0(" rx ");
+    putsUart0(longToChar(rx0Overflows));
+    putsUart0(" isr max ");
+    putsUart0(longToChar(uart0IsrMax / 40));
+    putsUart0("us");
+}
+
+/**
+ * @brief
+ *
+ * Function to handle UART0 interrupts. Transmit refills the FIFO from the transmit ring, receive moves bytes into
+ * the receive ring for the main loop. Receive interrupts come at half a FIFO, or at the timeout after the last byte.
+ */
+void Uart0Isr()
+{
+
+    uint32_t start = TIMESTAMP;
+    uint16_t next;
+
+    if (UART0_MIS_R & UART_MIS_TXMIS)
+    {
+        drainUart0();
+    }
+    UART0_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
+    while (!(UART0_FR_R & UART_FR_RXFE))
+    {
+        next = (rx0Head + 1) & (RX0_SIZE - 1);
+        if (next != rx0Tail)
+        {
+            rx0Buffer[rx0Head] = UART0_DR_R & 0xFF;
+            rx0Head = next;
+        }
+        else
+        {
+            UART0_DR_R;
+            ++rx0Overflows;
+        }
+    }
+    if (TIMESTAMP - start > uart0IsrMax)
+    {
+        uart0IsrMax = TIMESTAMP - start;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to run the console from the main loop. Uart0Isr only queues received bytes, so line editing, parsing and
+ * flash or EEPROM writes never hold off the DMX interrupts.
+ */
+void serviceConsole()
+{
+
+    uint8_t c;
+
+    if (frameState && TIMESTAMP - frameLast > FRAME_TIMEOUT)
+    {
+        frameState = 0;
+    }
+    if (enttecState && TIMESTAMP - enttecLast > FRAME_TIMEOUT)
+    {
+        enttecAbort();
+    }
+    while (rx0Tail != rx0Head)
+    {
+        c = rx0Buffer[rx0Tail];
+        rx0Tail = (rx0Tail + 1) & (RX0_SIZE - 1);
+        if (loading)
+        {
+            //show images are binary, so bypass the line editor
+            loadByte(c);
+        }
+        else if (enttec && (enttecState || c == ENTTEC_START))
+        {
+            enttecByte(c);
+        }
+        else if (frameState || c == FRAME_START)
+        {
+            frameByte(c);
+        }
+        else
+        {
+            consoleChar(c);
         }
+    }
+    if (enttec && mode == 0)
+    {
+        enttecReceived();
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to take one byte of an Enttec DMX USB Pro packet: 0x7E, label, 16-bit little endian length, data, 0xE7.
+ * Output only send DMX (label 6) data goes straight into the back universe of universe 1 as it arrives, the start
+ * code into the byte before the slots. The universe is only published if the end byte arrives.
+ */
+void enttecByte(uint8_t c /**< [in] received byte */)
+{
 
-        else if (strcmp(command, "set") == 0)
+    enttecLast = TIMESTAMP;
+    switch (enttecState)
+    {
+    case 0:
+        enttecState = 1;
+        break;
+    case 1:
+        enttecLabel = c;
+        enttecState = 2;
+        break;
+    case 2:
+        enttecLength = c;
+        enttecState = 3;
+        break;
+    case 3:
+        enttecLength |= c << 8;
+        enttecPos = 0;
+        if (enttecLabel == 6)
         {
-            uint16_t addr = atoi(arg1);
-            if (addr > 0 && addr < 513)
+            if (mode != 1 || enttecLength > 513)
             {
-                putsUart0("\n\rSetting:");
-                putsUart0("\n\r Address:");
-                putsUart0(intToChar(addr));
-                putsUart0("\n\r Value:");
-                putsUart0(arg2);
-                dmxData[addr - 1] = atoi(arg2);
+                //consume the packet without touching the universe
+                enttecLabel = 0;
             }
-
             else
             {
-                putsUart0("\n\rAddresses from 1 to 512 only.\n\r");
+                beginDMXWrite(0);
             }
-
-            return 0;
-        }
-        else if (strcmp(command, "get") == 0)
-        {
-            putsUart0("\n\rGetting:");
-            putsUart0("\n\rAddress:");
-            putsUart0(arg1);
-            putsUart0("\n\rValue:");
-            uint16_t addr = atoi(arg1);
-            if (addr > 0)
-                putsUart0(intToChar(dmxData[addr - 1]));
-            else
-                putsUart0("\n\rAddresses from 1 to 512 only.\n\r");
-
-            return 0;
         }
-
-        else if (strcmp(command, "max") == 0)
+        enttecState = enttecLength ? 4 : 5;
+        break;
+    case 4:
+        if (enttecLabel == 6)
         {
-            putsUart0("\n\rSetting Max to ");
-            putsUart0(arg1);
-            maxAddress = atoi(arg1);
-            return 0;
+            dmxData[enttecPos - 1] = c;
         }
-        else if (strcmp(command, "on") == 0)
+        else if (enttecLabel == 4 && enttecPos < 5)
         {
-            putsUart0("\n\rContinuous On\n\r");
-            continuous = 1;
-            GPIO_PORTC_DATA_R = 0x40;
-            return 0;
+            enttecParams[enttecPos] = c;
         }
-        else if (strcmp(command, "off") == 0)
+        if (++enttecPos == enttecLength)
         {
-            putsUart0("\n\rContinuous off\n\r");
-            continuous = 0;
-            return 0;
+            enttecState = 5;
         }
-        else if (strcmp(command, "controller") == 0)
+        break;
+    case 5:
+        if (c == ENTTEC_END)
         {
-            UART1_IM_R = UART_IM_TXIM;
-            putsUart0("\n\rAlready in Controller Mode\n\r");
-
-            return 0;
+            enttecDone();
         }
         else
         {
-            putsUart0("\n\rInvalid Controller Mode Command\r\n");
-            printCommandList();
-            return 0;
+            enttecAbort();
         }
+        break;
     }
+}
 
-    //device Mode
-    else if (mode == 0)
+/**
+ * @brief
+ *
+ * Function to carry out a complete Enttec packet
+ */
+void enttecDone()
+{
+
+    uint8_t reply[5];
+    uint16_t slots;
+
+    enttecState = 0;
+    if (enttecLabel == 6)
     {
-        if (strcmp(command, "address") == 0)
-        {
-            putsUart0("\n\rDevice address set to: ");
-            putsUart0(arg1);
-            deviceModeAddress = atoi(arg1);
-            EEWRITE(1, 2, deviceModeAddress);
-            return 0;
-        }
-        else if (strcmp(command, "device") == 0)
+        //slots past the end of the packet are not part of the universe any more
+        slots = enttecLength ? enttecLength - 1 : 0;
+        if (enttecLength == 0)
         {
-            UART1_IFLS_R = UART_IFLS_RX1_8;
-            UART1_IM_R = UART_IM_RXIM;
-            GPIO_PORTC_AFSEL_R |= 0x30;
-            GPIO_PORTC_DATA_R &= 0x9F;
-            UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2;
-            UART1_CTL_R = UART_CTL_RXE | UART_CTL_UARTEN;
-            TIMER1_CTL_R |= TIMER_CTL_TAEN;
-            putsUart0("\n\rAlready in Device Mode\n\r");
-            return 0;
+            dmxData[-1] = 0;
         }
-        else if (strcmp(command, "controller") == 0)
+        memset(dmxData + slots, 0, 512 - slots);
+        endDMXWrite(0);
+    }
+    else if (enttecLabel == 3)
+    {
+        //get widget parameters: firmware version, break and mark after break in 10.67 us, rate
+        reply[0] = 0x44;
+        reply[1] = 0x01;
+        reply[2] = (breakTime * 3 + 16) / 32;
+        reply[3] = (mabTime * 3 + 16) / 32;
+        reply[4] = refreshRate;
+        enttecPacket(3, reply, 5, 0, 0);
+    }
+    else if (enttecLabel == 4 && enttecLength >= 5)
+    {
+        //set widget parameters, kept to the limits of the break, mab and rate commands
+        if (enttecParams[2] * 32 / 3 >= 92)
         {
-            UART1_IM_R = UART_IM_TXIM;
-            GPIO_PORTC_DATA_R &= 0xDF;
-            putsUart0("\n\rController Mode\n\r");
-            mode = 1;
-            EEWRITE(0, 2, 1);
-            return 0;
+            breakTime = enttecParams[2] * 32 / 3;
         }
-        else
+        if (enttecParams[3] * 32 / 3 >= 12)
         {
-            putsUart0("\n\rInvalid Device Mode Command\n\r");
-            printCommandList();
-            return 0;
+            mabTime = enttecParams[3] * 32 / 3;
         }
+        refreshRate = enttecParams[4];
     }
-    else
+    else if (enttecLabel == 10)
     {
-        putsUart0("\n\rInvalid Mode\n\r");
-        return 1;
+        //get widget serial number
+        reply[0] = 0x01;
+        reply[1] = reply[2] = reply[3] = 0;
+        enttecPacket(10, reply, 4, 0, 0);
     }
 }
 
 /**
  * @brief
  *
- * Function to clear command, arg1, and arg2 arrays.
+ * Function to abandon an Enttec packet. A half written universe is dropped, not published.
  */
-void clearStr()
+void enttecAbort()
 {
 
-    uint8_t i = 0;
-    for (; i < 20; ++i)
+    if (enttecLabel == 6 && enttecState >= 4)
     {
-        command[i] = '\0';
-        arg1[i] = '\0';
-        arg2[i] = '\0';
+        abortDMXWrite(0);
     }
-    pos = 0;
-    enteringField = 0;
+    enttecState = 0;
 }
 
 /**
  * @brief
  *
- * Function to check if character is letter
+ * Function to send an Enttec packet made of a short header and a payload
  */
-bool isLetter(char c /**< character to check */)
+void enttecPacket(uint8_t label /**< [in] label */, const uint8_t* head /**< [in] header bytes */,
+        uint8_t headLength /**< [in] header length */, const uint8_t* data /**< [in] payload, 0 for none */,
+        uint16_t length /**< [in] payload length */)
 {
 
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    uint16_t total = headLength + length;
+    uint16_t i;
+
+    putcUart0(ENTTEC_START);
+    putcUart0(label);
+    putcUart0(total);
+    putcUart0(total >> 8);
+    for (i = 0; i < headLength; ++i)
+    {
+        putcUart0(head[i]);
+    }
+    for (i = 0; data && i < length; ++i)
+    {
+        putcUart0(data[i]);
+    }
+    putcUart0(ENTTEC_END);
 }
 
 /**
  * @brief
  *
- * Function to check if character is number
+ * Function to send the last received universe to the host as a received DMX packet (label 5). Frames are skipped
+ * while the transmit ring lacks room, so the packet rate follows the baud rate instead of overflowing the ring.
  */
-bool isNumber(char c /**< character to check */)
+void enttecReceived()
 {
 
-    return (c >= '0' && c <= '9');
+    uint8_t head[2];
+    uint16_t slots = rxStats.slots > 512 ? 512 : rxStats.slots;
+
+    if (rxStats.frames == enttecFrames
+            || ((tx0Tail - tx0Head - 1) & (TX0_SIZE - 1)) < slots + 8)
+    {
+        return;
+    }
+    enttecFrames = rxStats.frames;
+    head[0] = 0;
+    head[1] = dmxFront[-1];
+    enttecPacket(5, head, 2, dmxFront, slots);
 }
 
 /**
  * @brief
  *
- * Function to print available commands to user
+ * Function to add a byte to a CRC-16/CCITT
  */
-void printCommandList()
+uint16_t crc16(uint16_t crc /**< [in] running CRC, 0xFFFF to start */, uint8_t c /**< [in] byte */)
 {
 
-    putsUart0("\n\rAvailable Commands:\r\n");
-    putsUart0("For Device Mode:\r\n");
-    putsUart0("\tcontroller\n\r");
-    putsUart0("\taddress <address of device>\r\n");
+    return (crc << 8) ^ crcTable[(crc >> 8) ^ c];
+}
 
-    putsUart0("For Controller Mode:\r\n");
-    putsUart0("\tdevice\r\n");
-    putsUart0("\tset <address>,<value>\r\n");
-    putsUart0("\tget <address>,<value>\r\n");
-    putsUart0(
-            "\twoo < 0 for no woo :( \r\n\t    | 1 for all addresses 255 \r\n\t    | 2 for ramp animation >\r\n");
-    putsUart0(
-            "\twoo < 3 for servo angle set \r\n\t    | 4 for servo sweep \r\n\t    | 5 for special ramping function >\r\n");
-    putsUart0("\tmax <number of addresses>\r\n");
+/**
+ * @brief
+ *
+ * Function to take one byte of a binary console frame: FRAME_START, opcode, offset, length, payload, CRC. Offset,
+ * length and CRC are 16-bit little endian, the offset is universe * 512 + slot and the CRC covers the opcode to the
+ * end of the payload. Every frame gets a reply in the same format so a host can keep one frame in flight.
+ */
+void frameByte(uint8_t c /**< [in] received byte */)
+{
+
+    frameLast = TIMESTAMP;
+    switch (frameState)
+    {
+    case 0:
+        frameState = 1;
+        framePos = 0;
+        frameCrc = 0xFFFF;
+        break;
+    case 1:
+        frameHeader[framePos++] = c;
+        frameCrc = crc16(frameCrc, c);
+        if (framePos == 5)
+        {
+            frameLength = frameHeader[3] | (frameHeader[4] << 8);
+            framePos = 0;
+            if (frameHeader[0] == FRAME_READ)
+            {
+                //reads carry the length to read, not a payload
+                frameState = 3;
+            }
+            else if (frameLength <= 512)
+            {
+                frameState = frameLength ? 2 : 3;
+            }
+            else
+            {
+                frameState = 0;
+                frameReply(FRAME_ERROR, 2, 0, 0);
+            }
+        }
+        break;
+    case 2:
+        frameData[framePos++] = c;
+        frameCrc = crc16(frameCrc, c);
+        if (framePos == frameLength)
+        {
+            framePos = 0;
+            frameState = 3;
+        }
+        break;
+    case 3:
+        if (framePos++ == 0)
+        {
+            frameCrcIn = c;
+        }
+        else
+        {
+            frameCrcIn |= c << 8;
+            frameState = 0;
+            frameDone();
+        }
+        break;
+    }
+}
 
+/**
+ * @brief
+ *
+ * Function to carry out a complete binary console frame
+ */
+void frameDone()
+{
+
+    uint8_t op = frameHeader[0];
+    uint16_t offset = frameHeader[1] | (frameHeader[2] << 8);
+    uint8_t u = offset >> 9;
+    uint16_t slot = offset & 511;
+
+    if (frameCrc != frameCrcIn)
+    {
+        frameReply(FRAME_ERROR, 1, 0, 0);
+    }
+    else if (op == FRAME_BAUD)
+    {
+        uint32_t baud = frameData[0] | (frameData[1] << 8) | ((uint32_t) frameData[2] << 16)
+                | ((uint32_t) frameData[3] << 24);
+        if (frameLength != 4 || baud < 9600 || baud > 2500000)
+        {
+            frameReply(FRAME_ERROR, 2, 0, 0);
+            return;
+        }
+        frameReply(FRAME_BAUD | 0x80, 0, 0, 0);
+        setBaudUart0(baud);
+    }
+    else if (op != FRAME_WRITE && op != FRAME_READ)
+    {
+        frameReply(FRAME_ERROR, 3, 0, 0);
+    }
+    else if (u >= DMX_PORTS || slot + frameLength > 512)
+    {
+        frameReply(FRAME_ERROR, 2, 0, 0);
+    }
+    else if (op == FRAME_READ)
+    {
+        frameReply(FRAME_READ | 0x80, offset, ports[u].front + slot, frameLength);
+    }
+    else if (mode != 1)
+    {
+        frameReply(FRAME_ERROR, 4, 0, 0);
+    }
+    else
+    {
+        beginDMXWrite(u);
+        memcpy(ports[u].back + slot, frameData, frameLength);
+        endDMXWrite(u);
+        frameReply(FRAME_WRITE | 0x80, offset, 0, 0);
+    }
 }
 
 /**
  * @brief
  *
- * Function to wait for specified microseconds
+ * Function to send a binary console frame
  */
-void waitMicrosecond(uint32_t us /**< time to wait in microseconds */)
+void frameReply(uint8_t op /**< [in] opcode */, uint16_t offset /**< [in] offset, or reason of an error */,
+        const uint8_t* data /**< [in] payload, 0 for none */, uint16_t length /**< [in] length */)
 {
 
-    __asm("WMS_LOOP0:   MOV  R1, #6");
-    // 1
-    __asm("WMS_LOOP1:   SUB  R1, #1");
-    // 6
-    __asm("             CBZ  R1, WMS_DONE1");
-    // 5+1*3
-    __asm("             NOP");
-    // 5
-    __asm("             NOP");
-    // 5
-    __asm("             B    WMS_LOOP1");
-    // 5*2 (speculative, so P=1)
-    __asm("WMS_DONE1:   SUB  R0, #1");
-    // 1
-    __asm("             CBZ  R0, WMS_DONE0");
-    // 1
-    __asm("             NOP");
-    // 1
-    __asm("             B    WMS_LOOP0");
-    // 1*2 (speculative, so P=1)
-    __asm("WMS_DONE0:");
-    // ---
-    // 40 clocks/us + error
+    uint8_t header[5] = { op, offset, offset >> 8, length, length >> 8 };
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+
+    putcUart0(FRAME_START);
+    for (i = 0; i < 5; ++i)
+    {
+        putcUart0(header[i]);
+        crc = crc16(crc, header[i]);
+    }
+    for (i = 0; data && i < length; ++i)
+    {
+        putcUart0(data[i]);
+        crc = crc16(crc, data[i]);
+    }
+    putcUart0(crc);
+    putcUart0(crc >> 8);
 }
 
 /**
  * @brief
  *
- * Function to handle UART0 interrupts
+ * Function to change the UART0 baud rate once the transmit ring and FIFO have drained
  */
-void Uart0Isr()
+void setBaudUart0(uint32_t baud /**< [in] 9600 to 2500000 */)
 {
 
-    char c = getcUart0();
+    //divisor in 64ths, 40 MHz / (16 x baud)
+    uint32_t div = (160000000 + baud / 2) / baud;
+
+    //drained here rather than left to Uart0Isr, so the reply to the baud command goes out at the old rate
+    while (tx0Tail != tx0Head || (UART0_FR_R & UART_FR_BUSY))
+    {
+        _set_interrupt_priority(CONSOLE_BASEPRI);
+        drainUart0();
+        _set_interrupt_priority(0);
+    }
+    UART0_CTL_R = 0;
+    UART0_IBRD_R = div >> 6;
+    UART0_FBRD_R = div & 63;
+    UART0_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN; // latch the new divisor
+    UART0_CTL_R = UART_CTL_TXE | UART_CTL_RXE | UART_CTL_UARTEN;
+}
+
+/**
+ * @brief
+ *
+ * Function to edit the command line with one received character and run the command at the end of the line
+ */
+void consoleChar(char c /**< [in] received character */)
+{
 
     if (c == '\0')
     {
         return;
     }
     if (!(isLetter(c) || isNumber(c) || c == ' ' || c == '\n' || c == '\r'
-            || c == 8 || c == ','))
+            || c == 8 || c == ',' || c == ':'))
+    {
+        return;
+    }
+    if (dropLine)
+    {
+        if (c == '\n' || c == '\r')
+        {
+            dropLine = 0;
+            putsUart0("\r\n>");
+        }
+        return;
+    }
+
+    //a character that would fill the terminator of its field rejects the line
+    if (pos >= FIELD_SIZE - 1 && (isLetter(c) || isNumber(c) || c == ':'))
     {
+        putsUart0("\r\nField too long, line ignored.\r\n");
+        clearStr();
+        dropLine = 1;
         return;
     }
     if (isLetter(c) && enteringField == 0)
@@ -1141,7 +5241,7 @@ void Uart0Isr()
         ++enteringField;
         pos = 0;
     }
-    else if (enteringField == 1 && c == ',')
+    else if (enteringField >= 1 && enteringField < 4 && c == ',')
     {
         putcUart0(',');
         ++enteringField;
@@ -1154,16 +5254,26 @@ void Uart0Isr()
         putcUart0('>');
         clearStr();
     }
-    else if (enteringField == 1 && (isNumber(c) || isLetter(c)))
+    else if (enteringField == 1 && (isNumber(c) || isLetter(c) || c == ':'))
     {
         arg1[pos++] = c;
         putcUart0(c);
     }
-    else if (enteringField == 2 && (isNumber(c) || isLetter(c)))
+    else if (enteringField == 2 && (isNumber(c) || isLetter(c) || c == ':'))
     {
         arg2[pos++] = c;
         putcUart0(c);
     }
+    else if (enteringField == 3 && isNumber(c))
+    {
+        arg3[pos++] = c;
+        putcUart0(c);
+    }
+    else if (enteringField == 4 && isNumber(c))
+    {
+        arg4[pos++] = c;
+        putcUart0(c);
+    }
     else if (c == '\n' || c == '\r')
     {
         putcUart0(c);
@@ -1189,7 +5299,15 @@ void Uart0Isr()
     {
         if (pos > 0)
         {
-            if (enteringField == 2)
+            if (enteringField == 4)
+            {
+                arg4[--pos] = '\0';
+            }
+            else if (enteringField == 3)
+            {
+                arg3[--pos] = '\0';
+            }
+            else if (enteringField == 2)
             {
                 arg2[--pos] = '\0';
 
@@ -1210,7 +5328,15 @@ void Uart0Isr()
         else if (pos == 0)
         {
             enteringField--;
-            if (enteringField == 1)
+            if (enteringField == 3)
+            {
+                pos = strlen(arg3);
+            }
+            else if (enteringField == 2)
+            {
+                pos = strlen(arg2);
+            }
+            else if (enteringField == 1)
             {
                 pos = strlen(arg1);
             }
@@ -1261,10 +5387,13 @@ void wooone()
 {
 
     int x = 0;
+    beginDMXWrite(0);
+    stopFades(0, 0, 511);
     for (x = 0; x < 512; x += 1)
     {
         dmxData[x] = 255;
     }
+    endDMXWrite(0);
 
 }
 
@@ -1280,7 +5409,6 @@ void sweepServo()
     {
         GPIO_PORTF_AFSEL_R |= 0x0F;
         SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
         if (dmxData[deviceModeAddress + 0 - 1] * 100 >= 1400
                 && dmxData[deviceModeAddress + 0 - 1] * 100 <= 5800)
         {
@@ -1292,7 +5420,6 @@ void sweepServo()
     {
         GPIO_PORTF_AFSEL_R |= 0x0F;
         SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
-        TIMER2_CTL_R |= TIMER_CTL_TAEN;
         if (dmxData[deviceModeAddress + 0 - 1] * 100 >= 1400
                 && dmxData[deviceModeAddress + 0 - 1] * 100 <= 5800)
         {
@@ -1315,17 +5442,6 @@ void sweepServo()
     }
 }
 
-/**
- * @brief
- *
- * Function to enable ramping animation
- */
-void animationRamp()
-{
-
-    TIMER2_CTL_R = TIMER_CTL_TAEN;
-}
-
 /**
  * @brief
  *
@@ -1344,12 +5460,7 @@ uint8_t main()
         mode = 0;
         putsUart0("Device");
         TIMER1_CTL_R |= TIMER_CTL_TAEN;
-        UART1_IFLS_R = UART_IFLS_RX1_8;
-        UART1_IM_R = UART_IM_RXIM;
-        GPIO_PORTC_AFSEL_R |= 0x30;
-        GPIO_PORTC_DATA_R &= 0x9F;
-        UART1_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_STP2;
-        UART1_CTL_R = UART_CTL_RXE | UART_CTL_UARTEN;
+        configRxUart();
     }
     else
     {
@@ -1374,14 +5485,18 @@ uint8_t main()
     //Setting initial values for dmx for testing
     uint16_t x = 0;
 
+    beginDMXWrite(0);
     for (x = 0; x < 512; ++x)
     {
         dmxData[x] = x % 256;
     }
+    endDMXWrite(0);
 
     while (1)
     {
 
+        serviceConsole();
+
         //to read values from mux from DIP switch
         //NOT TESTED with DIP SWITCH
         if (!PUSH_BUTTON2)
@@ -1461,29 +5576,31 @@ uint8_t main()
 
         }
 
-        if (woo == 2)
-            animationRamp();
-        else
-        {
-            TIMER2_CTL_R &= ~TIMER_CTL_TAEN;
-        }
+        //woo 2, 4 and 5 are stepped once per frame by Timer2ISR
         if (woo == 1)
             wooone();
-        if (woo == 5)
-        {
-            TIMER2_CTL_R |= TIMER_CTL_TAEN;
-        }
 
         if (RGBMode && woo != 3 && woo != 4 && mode == 0)
         {
 
             GPIO_PORTF_AFSEL_R |= 0x0F;
             SYSCTL_RCGCPWM_R |= SYSCTL_RCGCPWM_R1;
-            PWM1_2_CMPB_R = dmxData[deviceModeAddress + 0 - 1] * 100; //red
+            if (personality && deviceModeAddress <= 507)
+            {
+                PWM1_2_CMPB_R = compare16(0, &dmxFront[deviceModeAddress + 0 - 1]); //red coarse, fine
+
+                PWM1_3_CMPB_R = compare16(1, &dmxFront[deviceModeAddress + 2 - 1]); //green coarse, fine
+
+                PWM1_3_CMPA_R = compare16(2, &dmxFront[deviceModeAddress + 4 - 1]); //blue coarse, fine
+            }
+            else
+            {
+                PWM1_2_CMPB_R = outputCompare[0][dmxFront[deviceModeAddress + 0 - 1]]; //red
 
-            PWM1_3_CMPB_R = dmxData[deviceModeAddress + 1 - 1] * 100;    //green
+                PWM1_3_CMPB_R = outputCompare[1][dmxFront[deviceModeAddress + 1 - 1]]; //green
 
-            PWM1_3_CMPA_R = dmxData[deviceModeAddress + 2 - 1] * 100; //blue
+                PWM1_3_CMPA_R = outputCompare[2][dmxFront[deviceModeAddress + 2 - 1]]; //blue
+            }
 
         }
         else
@@ -1492,7 +5609,7 @@ uint8_t main()
             GPIO_PORTF_AFSEL_R = 0;
             if (mode == 0)
             {
-                if (dmxData[deviceModeAddress - 1] != 0)
+                if (dmxFront[deviceModeAddress - 1] != 0)
                 {
                     BLUE_LED = 1;
                 }
@@ -10,7 +10,8 @@
 
 MEMORY
 {
-    FLASH (RX) : origin = 0x00000000, length = 0x00040000
+    FLASH (RX) : origin = 0x00000000, length = 0x00038000
+    SHOW  (R)  : origin = 0x00038000, length = 0x00008000    /* scenes and cue list, written at run time */
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
 
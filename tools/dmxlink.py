@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""Binary universe link for the DMX512 controller console.
+
+Talks the framed protocol handled by frameByte() in satej_matthew.c:
+
+    0xA5, opcode, offset (2), length (2), payload, CRC-16/CCITT (2)
+
+Multi-byte fields are little endian, the offset is universe * 512 + slot and
+the CRC covers the opcode to the end of the payload. Each frame gets a reply
+with the opcode | 0x80, or 0xFF with the reason in the offset field.
+
+Usage:
+    dmxlink.py --port /dev/ttyACM0 --baud 1000000 bench
+    dmxlink.py --port /dev/ttyACM0 --open-baud 1000000 read 0 8
+                                   console already moved by the baud command
+    dmxlink.py --port /dev/ttyACM0 write 0 255,128,0
+    dmxlink.py --port /dev/ttyACM0 read 512 16
+    dmxlink.py --pty bench         against a pseudo-terminal stand-in
+"""
+
+import argparse
+import os
+import pty
+import struct
+import sys
+import termios
+import threading
+import time
+import tty
+
+START = 0xA5
+WRITE = 0x01
+READ = 0x02
+BAUD = 0x03
+ERROR = 0xFF
+REASONS = {1: "CRC", 2: "range", 3: "opcode", 4: "not in controller mode"}
+UNIVERSES = 6
+
+
+def crc16(data, crc=0xFFFF):
+    for c in data:
+        crc ^= c << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def frame(op, offset, length, payload=b""):
+    body = struct.pack("<BHH", op, offset, length) + payload
+    return bytes([START]) + body + struct.pack("<H", crc16(body))
+
+
+def read_frame(read):
+    """Read one frame with read(n); returns (opcode, offset, length, payload)."""
+    while read(1)[0] != START:
+        pass
+    header = read(5)
+    op, offset, length = struct.unpack("<BHH", header)
+    payload = read(length) if op == READ | 0x80 else b""
+    crc, = struct.unpack("<H", read(2))
+    if crc != crc16(header + payload):
+        raise IOError("reply CRC mismatch")
+    return op, offset, length, payload
+
+
+class Link:
+    def __init__(self, path, baud):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        self.set_baud(baud)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+
+    def set_baud(self, baud):
+        attr = termios.tcgetattr(self.fd)
+        attr[0] = attr[1] = attr[3] = 0
+        attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attr[4] = attr[5] = getattr(termios, "B%d" % baud)
+        attr[6][termios.VMIN] = 0
+        attr[6][termios.VTIME] = 10
+        termios.tcsetattr(self.fd, termios.TCSADRAIN, attr)
+
+    def read(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = os.read(self.fd, n - len(data))
+            if not chunk:
+                raise IOError("no reply from the controller")
+            data += chunk
+        return data
+
+    def request(self, op, offset, length, payload=b""):
+        os.write(self.fd, frame(op, offset, length, payload))
+        reply = read_frame(self.read)
+        if reply[0] == ERROR:
+            raise IOError("frame rejected: %s" % REASONS.get(reply[1], reply[1]))
+        return reply
+
+    def write(self, offset, levels):
+        self.request(WRITE, offset, len(levels), bytes(levels))
+
+    def read_slots(self, offset, length):
+        return self.request(READ, offset, length)[3]
+
+    def baud(self, baud):
+        self.request(BAUD, 0, 4, struct.pack("<I", baud))
+        self.set_baud(baud)
+
+
+class StandIn(threading.Thread):
+    """Answers frames on a pty master the way the controller does."""
+
+    def __init__(self, master):
+        super().__init__(daemon=True)
+        self.master = master
+        self.universes = bytearray(512 * UNIVERSES)
+
+    def read(self, n):
+        data = b""
+        while len(data) < n:
+            data += os.read(self.master, n - len(data))
+        return data
+
+    def reply(self, op, offset, payload=b""):
+        os.write(self.master, frame(op, offset, len(payload), payload))
+
+    def run(self):
+        try:
+            while True:
+                self.step()
+        except OSError:
+            pass
+
+    def step(self):
+        while self.read(1)[0] != START:
+            pass
+        header = self.read(5)
+        op, offset, length = struct.unpack("<BHH", header)
+        payload = self.read(length) if op != READ and length <= 512 else b""
+        if length > 512 and op != READ:
+            return self.reply(ERROR, 2)
+        if struct.unpack("<H", self.read(2))[0] != crc16(header + payload):
+            return self.reply(ERROR, 1)
+        if op == BAUD:
+            return self.reply(BAUD | 0x80, 0)
+        if op not in (READ, WRITE):
+            return self.reply(ERROR, 3)
+        if offset >> 9 >= UNIVERSES or (offset & 511) + length > 512:
+            return self.reply(ERROR, 2)
+        if op == READ:
+            return self.reply(READ | 0x80, offset, bytes(self.universes[offset:offset + length]))
+        self.universes[offset:offset + length] = payload
+        self.reply(WRITE | 0x80, offset)
+
+
+def open_pty():
+    master, slave = pty.openpty()
+    tty.setraw(master)
+    StandIn(master).start()
+    path = os.ttyname(slave)
+    return path, slave
+
+
+def bench(link, universe, frames):
+    start = time.monotonic()
+    for n in range(frames):
+        link.write(universe * 512, bytes((ch + n) & 0xFF for ch in range(512)))
+    elapsed = time.monotonic() - start
+    last = bytes((ch + frames - 1) & 0xFF for ch in range(512))
+    if link.read_slots(universe * 512, 512) != last:
+        raise IOError("universe read back differs from the last write")
+    rate = frames / elapsed
+    print("%d full universe writes in %.3f s: %.1f updates/s, %.1f kB/s%s"
+          % (frames, elapsed, rate, rate * 520 / 1000, "" if rate >= 44 else " (below DMX refresh)"))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Write and read controller universes over the binary console protocol.")
+    where = ap.add_mutually_exclusive_group(required=True)
+    where.add_argument("--port", help="serial port of the controller console")
+    where.add_argument("--pty", action="store_true", help="use a pseudo-terminal stand-in for the controller")
+    ap.add_argument("--open-baud", type=int, default=115200,
+                    help="baud rate the console runs at now, 115200 unless changed by the baud command")
+    ap.add_argument("--baud", type=int, help="baud rate to switch the console to")
+    sub = ap.add_subparsers(dest="command", required=True)
+    b = sub.add_parser("bench", help="stream full universes and report updates/s")
+    b.add_argument("--frames", type=int, default=200)
+    b.add_argument("--universe", type=int, default=0)
+    w = sub.add_parser("write", help="write levels from an offset")
+    w.add_argument("offset", type=int, help="universe * 512 + slot, slot 0 based")
+    w.add_argument("levels", help="comma separated levels")
+    r = sub.add_parser("read", help="read levels from an offset")
+    r.add_argument("offset", type=int)
+    r.add_argument("length", type=int)
+    args = ap.parse_args()
+
+    try:
+        path = args.port
+        if args.pty:
+            path, slave = open_pty()
+        link = Link(path, args.open_baud)
+        if args.baud is not None and args.baud != args.open_baud:
+            link.baud(args.baud)
+        if args.command == "bench":
+            bench(link, args.universe, args.frames)
+        elif args.command == "write":
+            link.write(args.offset, [int(x) for x in args.levels.split(",")])
+        else:
+            print(",".join(str(x) for x in link.read_slots(args.offset, args.length)))
+    except (IOError, OSError, AttributeError, ValueError) as e:
+        sys.exit("dmxlink: %s" % e)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+"""Show compiler for the DMX512 controller.
+
+Compiles a text show description into the binary image taken by the
+controller's `load` command, and optionally sends it over the UART0 console.
+
+Show file, one statement per line, fields split by spaces or commas
+(so a CSV export works), '#' starts a comment:
+
+    scene <0 to 47>
+    <address>[-<address>] <level>           levels of the current scene
+    cue <0 to 127> <scene> <fade in ms> <fade out ms> [wait ms]
+    gen <0 to 7> <waveform> <first> <last> [rate spread amplitude]
+
+Addresses are 1 to 512. Scenes start black. Waveforms are off, sine,
+triangle, square, saw, random, chase or their number 0 to 6. Times are
+stored in 10 ms ticks like the console commands.
+
+Usage:
+    showc.py show.txt -o show.bin          compile
+    showc.py show.txt --verify             compile, decode and compare
+    showc.py show.txt --port /dev/ttyACM0  compile and load
+    showc.py show.txt --port /dev/ttyACM0 --baud 1000000
+                                           load through a console moved by the baud command
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import time
+
+SCENES = 48
+CUES = 128
+GENERATORS = 8
+WAVES = ["off", "sine", "triangle", "square", "saw", "random", "chase"]
+MAGIC = b"DMXS"
+VERSION = 2
+RUN_GAP = 3  # unchanged levels worth sending rather than opening a new run
+
+
+class ShowError(Exception):
+    pass
+
+
+def parse(path):
+    """Read a show file into (scenes, cues, generators) dictionaries."""
+    scenes, cues, gens = {}, {}, {}
+    scene = None
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            fields = line.split("#", 1)[0].replace(",", " ").split()
+            if not fields:
+                continue
+            try:
+                key = fields[0].lower()
+                if key == "scene":
+                    n = int(fields[1])
+                    check(0 <= n < SCENES, "scene 0 to 47")
+                    scene = scenes.setdefault(n, bytearray(512))
+                elif key == "cue":
+                    n, s, fade_in, fade_out = (int(x) for x in fields[1:5])
+                    wait = int(fields[5]) if len(fields) > 5 else 0
+                    check(0 <= n < CUES, "cue 0 to 127")
+                    check(0 <= s < SCENES, "scene 0 to 47")
+                    cues[n] = (s, ticks(fade_in), ticks(fade_out), ticks(wait))
+                elif key == "gen":
+                    g = int(fields[1])
+                    w = fields[2].lower()
+                    w = WAVES.index(w) if w in WAVES else int(w)
+                    first, last = int(fields[3]), int(fields[4])
+                    rate, spread, amplitude = (int(x) for x in fields[5:8]) if len(fields) > 7 else (256, 0, 256)
+                    check(0 <= g < GENERATORS, "generator 0 to 7")
+                    check(0 <= w < len(WAVES), "waveform 0 to 6")
+                    check(1 <= first <= last <= 512, "addresses 1 to 512")
+                    check(0 <= amplitude <= 256, "amplitude 0 to 256")
+                    check(0 <= rate < 65536 and 0 <= spread < 65536, "rate and spread 0 to 65535")
+                    gens[g] = (w, first - 1, last - 1, rate, spread, amplitude)
+                else:
+                    check(scene is not None, "levels before any scene")
+                    check(len(fields) == 2, "<address>[-<address>] <level>")
+                    first, _, last = fields[0].partition("-")
+                    first = int(first)
+                    last = int(last) if last else first
+                    level = int(fields[1])
+                    check(1 <= first <= last <= 512, "addresses 1 to 512")
+                    check(0 <= level <= 255, "level 0 to 255")
+                    scene[first - 1:last] = bytes([level]) * (last - first + 1)
+            except (ValueError, IndexError, ShowError) as e:
+                raise ShowError("%s:%d: %s" % (path, number, e or "bad statement"))
+    return scenes, cues, gens
+
+
+def check(ok, message):
+    if not ok:
+        raise ShowError(message)
+
+
+def ticks(ms):
+    check(0 <= ms <= 655350, "times 0 to 655350 ms")
+    return ms // 10
+
+
+def runs(previous, scene):
+    """Split the changes from the previous scene into (first, levels) runs."""
+    out = []
+    ch = 0
+    while ch < 512:
+        if scene[ch] == previous[ch]:
+            ch += 1
+            continue
+        first = end = ch
+        while ch < 512 and ch - first < 255:
+            if scene[ch] != previous[ch]:
+                end = ch + 1
+            elif ch - end >= RUN_GAP:
+                break
+            ch += 1
+        out.append((first, bytes(scene[first:end])))
+        ch = end
+    return out
+
+
+def compile_show(scenes, cues, gens):
+    image = bytearray(MAGIC) + bytes([VERSION])
+    previous = bytes(512)
+    for n in sorted(scenes):
+        record = bytearray(b"S" + bytes([n]))
+        for first, levels in runs(previous, scenes[n]):
+            record += struct.pack("<BH", len(levels), first) + levels
+        record += b"\0"
+        # checked by the controller before the scene is written to flash
+        image += record + struct.pack("<H", sum(record) & 0xFFFF)
+        previous = scenes[n]
+    for n in sorted(cues):
+        image += b"C" + struct.pack("<BBHHH", n, *cues[n])
+    for g in sorted(gens):
+        image += b"G" + struct.pack("<BBHHHHH", g, *gens[g])
+    image += b"E"
+    image += struct.pack("<H", sum(image) & 0xFFFF)
+    return bytes(image)
+
+
+def records(image):
+    """Split an image into records, checking it the way the firmware does."""
+    check(image[:5] == MAGIC + bytes([VERSION]), "not a version %d show image" % VERSION)
+    pos = 5
+    while True:
+        start = pos
+        kind = image[pos:pos + 1]
+        pos += 1
+        if kind == b"S":
+            pos += 1
+            while image[pos]:
+                pos += 3 + image[pos]
+            pos += 3
+        elif kind in (b"C", b"G", b"E"):
+            pos += {b"C": 8, b"G": 12, b"E": 2}[kind]
+        else:
+            raise ShowError("bad record at byte %d" % start)
+        check(pos <= len(image), "image truncated")
+        yield kind, image[start:pos]
+        if kind == b"E":
+            check(pos == len(image), "data after the end record")
+            return
+
+
+def decode(image):
+    """Rebuild (scenes, cues, generators) from an image."""
+    scenes, cues, gens = {}, {}, {}
+    levels = bytearray(512)
+    for kind, record in records(image):
+        if kind == b"S":
+            pos = 2
+            while record[pos]:
+                length, first = struct.unpack_from("<BH", record, pos)
+                check(first + length <= 512, "run past channel 512")
+                levels[first:first + length] = record[pos + 3:pos + 3 + length]
+                pos += 3 + length
+            check(struct.unpack("<H", record[-2:])[0] == sum(record[:-2]) & 0xFFFF,
+                  "bad checksum in scene %d" % record[1])
+            scenes[record[1]] = bytearray(levels)
+        elif kind == b"C":
+            n, *cue = struct.unpack("<BBHHH", record[1:])
+            cues[n] = tuple(cue)
+        elif kind == b"G":
+            g, *gen = struct.unpack("<BBHHHHH", record[1:])
+            gens[g] = tuple(gen)
+        else:
+            check(struct.unpack("<H", record[1:])[0] == sum(image[:-2]) & 0xFFFF, "bad checksum")
+    return scenes, cues, gens
+
+
+def verify(show, image):
+    decoded = decode(image)
+    for name, a, b in zip(("scene", "cue", "generator"), show, decoded):
+        check(a.keys() == b.keys(), "%s numbers differ" % name)
+        for n in a:
+            check(a[n] == b[n], "%s %d differs" % (name, n))
+
+
+def expect(fd, endings, timeout):
+    """Read from the console until one of the endings arrives."""
+    seen = b""
+    deadline = time.monotonic() + timeout
+    while not any(seen.endswith(e) for e in endings):
+        check(time.monotonic() < deadline, "no reply from the controller")
+        seen += os.read(fd, 64)
+    check(b"failed" not in seen, "controller rejected the image")
+    return seen
+
+
+def upload(port, image, baud):
+    speed = getattr(termios, "B%d" % baud, None)
+    check(speed is not None, "baud rate %d not supported by this host" % baud)
+    fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+    try:
+        attr = termios.tcgetattr(fd)
+        attr[0] = attr[1] = attr[3] = 0
+        attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attr[4] = attr[5] = speed
+        attr[6][termios.VMIN] = 0
+        attr[6][termios.VTIME] = 1
+        termios.tcsetattr(fd, termios.TCSANOW, attr)
+        termios.tcflush(fd, termios.TCIOFLUSH)
+        os.write(fd, b"load\r")
+        expect(fd, [b">"], 2)
+        os.write(fd, image[:5])
+        for kind, record in records(image):
+            os.write(fd, record)
+            # scene records wait for a flash page erase and program
+            expect(fd, [b"."] if kind != b"E" else [b">"], 2)
+    finally:
+        os.close(fd)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Compile a show file into a controller show image.")
+    ap.add_argument("show", help="show description")
+    ap.add_argument("-o", "--output", help="image file to write")
+    ap.add_argument("--verify", action="store_true", help="decode the image and compare it with the show")
+    ap.add_argument("--port", help="serial port of the controller console to load the image into")
+    ap.add_argument("--baud", type=int, default=115200, help="baud rate the console runs at, as set by its baud command")
+    args = ap.parse_args()
+
+    try:
+        show = parse(args.show)
+        image = compile_show(*show)
+        if args.verify:
+            verify(show, image)
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(image)
+        if args.port:
+            upload(args.port, image, args.baud)
+    except (ShowError, OSError) as e:
+        sys.exit("showc: %s" % e)
+    print("%d scenes, %d cues, %d generators, %d bytes%s"
+          % (len(show[0]), len(show[1]), len(show[2]), len(image), ", verified" if args.verify else ""))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,1405 @@
+/**
+ * @file double.c
+ * @brief Linux test double of the TM4C123GH6PM peripherals used by satej_matthew.c. <br>
+ * The peripheral and NVIC pages are a shared memory file mapped twice: at their real addresses with no access, and
+ * somewhere else read/write for the model. A firmware access faults, the model updates the register through the
+ * second mapping, opens the page and single steps the access with the trap flag, then closes the page again.
+ * Reads get their value before the access, writes are handed to the model after it. <br>
+ * Bit-band aliases of port F and the scene/cue flash are plain memory. <br>
+ * Only the behavior the firmware relies on is modelled:
+ * - UARTs: 8 data bits, FIFO or holding register, TX level/EOT and RX level/timeout interrupts, LCRH BRK,
+ *   break/framing/overrun flags, uDMA requests. UART0 transmits at once into the console log.
+ * - uDMA basic mode on channel 22 (UART1 RX) and 23 (UART1 TX). Completion pends the UART1 interrupt.
+ * - Timers 0 to 3 one shot and periodic, Timer 0 counts the 40 MHz time, Wide Timer 5 captures both edges of PD6.
+ * - NVIC enables, priorities and software trigger. Handlers never nest.
+ * - EEPROM words and flash write/erase, with the CPU stall they cause.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "double.h"
+
+#define PERIPH_BASE 0x40000000 /*!< First peripheral register page. */
+
+#define PERIPH_SIZE 0x00100000 /*!< Peripheral registers up to the uDMA controller. */
+
+#define NVIC_BASE 0xE000E000 /*!< System control space page with the NVIC. */
+
+#define BITBAND_BASE 0x424A7000 /*!< Bit-band page holding the port F data bits. */
+
+#define FLASH_BASE 0x00038000 /*!< Scene and cue flash pages. */
+
+#define FLASH_SIZE 0x00008000 /*!< Up to the end of the 256 KB flash. */
+
+#define FLASH_ERASE 600000 /*!< Cycles the CPU stalls for while a flash page is erased, 15 ms. */
+
+#define FLASH_PROGRAM 2000 /*!< Cycles the CPU stalls for while a flash word is programmed, 50 us. */
+
+#define PAGE 0x1000 /*!< Host page size. */
+
+#define UART0_BASE 0x4000C000 /*!< UART n is at UART0_BASE + n * 0x1000. */
+
+#define UDMA_BASE 0x400FF000 /*!< uDMA controller registers. */
+
+#define UDMA_RX 22 /*!< uDMA channel of UART1 receive. */
+
+#define UDMA_TX 23 /*!< uDMA channel of UART1 transmit. */
+
+#define TIMERS 5 /*!< Timer 0 to 3 and Wide Timer 5. */
+
+#define DMX_BIT 160 /*!< 250 kbaud bit time of the receive line, in clock cycles. */
+
+#define VECTORS 155 /*!< Vector table entries of the TM4C123GH6PM. */
+
+#define LINE_EDGES 262144 /*!< Receive line transitions the script can hold. */
+
+#define CONSOLE_OUT 262144 /*!< Console output kept by the log. */
+
+#define REG(a) (*(volatile uint32_t*) (alias + ((a) >= NVIC_BASE ? (a) - NVIC_BASE + PERIPH_SIZE : (a) - PERIPH_BASE)))
+
+/**
+ * Model state of one UART. Configuration is read from the registers themselves.
+ */
+typedef struct
+{
+    uint16_t rx[16]; /*!< Receive FIFO, data with error flags like DR reads them. */
+    uint8_t rxHead; /*!< Oldest receive FIFO entry. */
+    uint8_t rxCount; /*!< Receive FIFO entries. */
+    uint8_t tx[16]; /*!< Transmit FIFO. */
+    uint8_t txHead; /*!< Oldest transmit FIFO entry. */
+    uint8_t txCount; /*!< Transmit FIFO entries. */
+    bool shifting; /*!< A character is in the serializer. */
+    uint64_t shiftEnd; /*!< Cycle the stop bits of the character in the serializer end. */
+    uint64_t rtDeadline; /*!< Cycle the receive timeout fires if nothing else arrives. */
+    uint32_t ris; /*!< Raw interrupt status. */
+    uint32_t rsr; /*!< Receive status. */
+    bool brk; /*!< LCRH BRK as last written. */
+    bool dmaDone; /*!< A uDMA channel of this UART completed, pending on its vector. */
+    simFrame frames[SIM_FRAMES]; /*!< Transmit log, ring of the last frames. */
+    uint16_t frameCount; /*!< Breaks sent since the log was cleared. */
+} uartModel;
+
+/**
+ * Model state of one timer.
+ */
+typedef struct
+{
+    bool running; /*!< TAEN as last written, cleared when a one shot times out. */
+    uint64_t expire; /*!< Cycle of the next time out while running. */
+    uint32_t remaining; /*!< Cycles left when the timer is started again. */
+    uint32_t ris; /*!< Raw interrupt status. */
+    uint32_t tar; /*!< Last captured edge. */
+} timerModel;
+
+static uint8_t* alias; /*!< Read/write mapping of the peripheral and NVIC pages. */
+static uint64_t now; /*!< 40 MHz cycles since simInit. */
+static uint32_t trapAddress; /*!< Register being single stepped. */
+static bool trapWrite; /*!< The single stepped access is a write. */
+static bool trapping; /*!< A page is open for one access. */
+static uint64_t flashBusy; /*!< Cycles the last flash command stalls the CPU for. */
+static void (*vectors[VECTORS])(); /*!< Interrupt handlers by vector number. */
+static bool swPending[VECTORS]; /*!< Interrupts pended by NVIC_SW_TRIG_R. */
+static uint32_t isrCount[VECTORS]; /*!< Interrupts taken by vector number. */
+static uint32_t nvicEnable[5]; /*!< NVIC_EN0_R to NVIC_EN4_R, set there and cleared through NVIC_DIS0_R to NVIC_DIS4_R. */
+static void (*idleHook)(); /*!< Main loop pass, run whenever time advances. */
+static uartModel uarts[SIM_UARTS]; /*!< UART0 to UART7. */
+static timerModel timers[TIMERS]; /*!< Timer 0 to 3 and Wide Timer 5. */
+static uint32_t udmaEnabled; /*!< Enabled uDMA channels. */
+static uint32_t udmaChis; /*!< uDMA channel interrupt status. */
+static uint32_t eeprom[32][16]; /*!< EEPROM words by block and offset. */
+static char consoleOut[CONSOLE_OUT]; /*!< Characters written to UART0. */
+static uint32_t consoleLength; /*!< Characters in consoleOut. */
+static char consoleIn[4096]; /*!< Characters still to arrive on UART0. */
+static uint16_t consoleInHead; /*!< Next character to arrive. */
+static uint16_t consoleInTail; /*!< End of the characters to arrive. */
+static uint64_t consoleInNext; /*!< Cycle the next character arrives on UART0. */
+static uint64_t lineAt[LINE_EDGES]; /*!< Cycles the receive line changes level at. */
+static uint8_t lineLevel[LINE_EDGES]; /*!< Level of the receive line from each change on. */
+static uint32_t lineEdges; /*!< Changes in the script. */
+static uint32_t lineNext; /*!< First change not yet seen by the capture timer. */
+static uint64_t lineTail; /*!< End of the script. */
+static bool jumper = true; /*!< PD6 is jumpered to U1RX. */
+static uint8_t rxState; /*!< UART1 receiver. 0: Idle, 1: Character, 2: Waiting for the line to go high */
+static uint64_t rxFrom; /*!< Receiver looks at the line from this cycle on. */
+static uint64_t rxStart; /*!< Falling edge of the start bit of the character being received. */
+
+static const uint8_t uartVector[SIM_UARTS] = { 21, 22, 49, 75, 0, 77, 78, 79 }; /*!< Vector of each UART, 0 for none. */
+
+static const uint8_t timerVector[TIMERS] = { 35, 37, 39, 51, 120 }; /*!< Vector of each timer. */
+
+static const uint32_t timerBase[TIMERS] = { 0x40030000, 0x40031000, 0x40032000, 0x40033000, 0x4004F000 }; /*!< Timer registers. */
+
+/**
+ * @brief
+ *
+ * Function to give the level of the receive line at a cycle. The line idles high before the script.
+ */
+static uint8_t lineAtCycle(uint64_t t /**< [in] cycle */)
+{
+
+    uint32_t lo = 0;
+    uint32_t hi = lineEdges;
+
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (lineAt[mid] <= t)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo == 0 ? 1 : lineLevel[lo - 1];
+}
+
+/**
+ * @brief
+ *
+ * Function to find the first change of the receive line to a level at or after a cycle, UINT64_MAX for none.
+ */
+static uint64_t lineChange(uint64_t t /**< [in] first cycle */, uint8_t level /**< [in] level changed to */)
+{
+
+    uint32_t lo = 0;
+    uint32_t hi = lineEdges;
+
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (lineAt[mid] < t)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    for (; lo < lineEdges; ++lo)
+    {
+        if (lineLevel[lo] == level)
+        {
+            return lineAt[lo];
+        }
+    }
+    return UINT64_MAX;
+}
+
+/**
+ * @brief
+ *
+ * Function to give the clock cycles of one bit of a UART.
+ */
+static uint64_t bitCycles(uint8_t n /**< [in] UART */)
+{
+
+    uint32_t base = UART0_BASE + n * 0x1000;
+    uint64_t divisor = REG(base + 0x024) * 64 + (REG(base + 0x028) & 0x3F);
+
+    return divisor ? divisor * 16 / 64 : 16;
+}
+
+/**
+ * @brief
+ *
+ * Function to give the clock cycles of one 8 bit character of a UART, stop bits included.
+ */
+static uint64_t charCycles(uint8_t n /**< [in] UART */)
+{
+
+    uint32_t base = UART0_BASE + n * 0x1000;
+
+    return bitCycles(n) * ((REG(base + 0x02C) & 0x08) ? 11 : 10);
+}
+
+/**
+ * @brief
+ *
+ * Function to give the FIFO depth of a UART, 1 when the FIFOs are off.
+ */
+static uint8_t fifoDepth(uint8_t n /**< [in] UART */)
+{
+
+    return (REG(UART0_BASE + n * 0x1000 + 0x02C) & 0x10) ? 16 : 1;
+}
+
+/**
+ * @brief
+ *
+ * Function to give the FIFO level of the transmit (shift 0) or receive (shift 3) interrupt select of IFLS.
+ */
+static uint8_t fifoLevel(uint8_t n /**< [in] UART */, uint8_t shift /**< [in] IFLS field */)
+{
+
+    static const uint8_t levels[8] = { 2, 4, 8, 12, 14, 14, 14, 14 };
+
+    if (fifoDepth(n) == 1)
+    {
+        return shift ? 1 : 0;
+    }
+    return levels[(REG(UART0_BASE + n * 0x1000 + 0x034) >> shift) & 7];
+}
+
+/**
+ * @brief
+ *
+ * Function to give the frame being logged on a UART, 0 before the first break.
+ */
+static simFrame* openFrame(uint8_t n /**< [in] UART */)
+{
+
+    uartModel* u = &uarts[n];
+
+    return u->frameCount ? &u->frames[(u->frameCount - 1) % SIM_FRAMES] : 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to move the next character of the transmit FIFO into the serializer when it is free.
+ */
+static void txStart(uint8_t n /**< [in] UART */)
+{
+
+    uartModel* u = &uarts[n];
+    uint32_t base = UART0_BASE + n * 0x1000;
+    uint32_t ctl = REG(base + 0x030);
+    simFrame* f = openFrame(n);
+    uint8_t c;
+
+    if (u->shifting || u->txCount == 0 || u->brk || (ctl & 0x101) != 0x101)
+    {
+        return;
+    }
+    c = u->tx[u->txHead];
+    u->txHead = (u->txHead + 1) & 15;
+    u->txCount--;
+    u->shifting = true;
+    u->shiftEnd = now + charCycles(n);
+    if (f)
+    {
+        if (f->count == 0)
+        {
+            f->dataStart = now;
+        }
+        if (f->count < SIM_FRAME_BYTES)
+        {
+            f->data[f->count] = c;
+        }
+        f->count++;
+    }
+
+    //level interrupt when the FIFO drains through the level, or the holding register empties
+    if (!(ctl & 0x10) && u->txCount == fifoLevel(n, 0))
+    {
+        u->ris |= 0x20;
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to take a character written to the data register of a UART.
+ */
+static void txWrite(uint8_t n /**< [in] UART */, uint8_t c /**< [in] character */)
+{
+
+    uartModel* u = &uarts[n];
+
+    if (n == 0)
+    {
+        //console output is logged at once, so the console never backs up
+        if (consoleLength < CONSOLE_OUT - 1)
+        {
+            consoleOut[consoleLength++] = c;
+            consoleOut[consoleLength] = 0;
+        }
+        return;
+    }
+    if (u->txCount >= fifoDepth(n))
+    {
+        return;
+    }
+    u->tx[(u->txHead + u->txCount) & 15] = c;
+    u->txCount++;
+    if ((REG(UART0_BASE + n * 0x1000 + 0x030) & 0x10) || u->txCount > fifoLevel(n, 0))
+    {
+        u->ris &= ~0x20;
+    }
+    txStart(n);
+}
+
+/**
+ * @brief
+ *
+ * Function to put a received character in the receive FIFO of a UART, or flag an overrun.
+ */
+static void rxPush(uint8_t n /**< [in] UART */, uint16_t entry /**< [in] character with error flags */)
+{
+
+    uartModel* u = &uarts[n];
+
+    if (u->rxCount >= fifoDepth(n))
+    {
+        u->rsr |= 0x08;
+        u->ris |= 0x400;
+        return;
+    }
+    u->rx[(u->rxHead + u->rxCount) & 15] = entry;
+    u->rxCount++;
+    if (entry & 0x400)
+    {
+        u->ris |= 0x200;
+    }
+    if (entry & 0x100)
+    {
+        u->ris |= 0x80;
+    }
+    if (u->rxCount >= fifoLevel(n, 3))
+    {
+        u->ris |= 0x10;
+    }
+    u->rtDeadline = now + 32 * bitCycles(n);
+}
+
+/**
+ * @brief
+ *
+ * Function to read the data register of a UART.
+ */
+static uint32_t rxRead(uint8_t n /**< [in] UART */)
+{
+
+    uartModel* u = &uarts[n];
+    uint16_t entry;
+
+    if (u->rxCount == 0)
+    {
+        return 0;
+    }
+    entry = u->rx[u->rxHead];
+    u->rxHead = (u->rxHead + 1) & 15;
+    u->rxCount--;
+    u->rsr = (u->rsr & 0x08) | ((entry >> 8) & 0x07);
+    if (u->rxCount < fifoLevel(n, 3))
+    {
+        u->ris &= ~0x10;
+    }
+    if (u->rxCount == 0)
+    {
+        u->ris &= ~0x40;
+    }
+    return entry;
+}
+
+/**
+ * @brief
+ *
+ * Function to give the value of a register for a read. Registers without side effects read back what was written.
+ */
+static uint32_t readRegister(uint32_t a /**< [in] register address */)
+{
+
+    uint8_t i;
+
+    if (a >= UART0_BASE && a < UART0_BASE + SIM_UARTS * 0x1000)
+    {
+        uint8_t n = (a - UART0_BASE) >> 12;
+        uartModel* u = &uarts[n];
+        switch (a & 0xFFF)
+        {
+        case 0x000:
+            return rxRead(n);
+        case 0x004:
+            return u->rsr;
+        case 0x018:
+            return (u->txCount == 0 ? 0x80 : 0) | (u->rxCount >= fifoDepth(n) ? 0x40 : 0)
+                    | (n > 0 && u->txCount >= fifoDepth(n) ? 0x20 : 0) | (u->rxCount == 0 ? 0x10 : 0)
+                    | (u->shifting || u->txCount ? 0x08 : 0);
+        case 0x03C:
+            return u->ris;
+        case 0x040:
+            return u->ris & REG(a - 0x040 + 0x038);
+        }
+    }
+    for (i = 0; i < TIMERS; ++i)
+    {
+        if (a >= timerBase[i] && a < timerBase[i] + 0x1000)
+        {
+            switch (a & 0xFFF)
+            {
+            case 0x01C:
+                return timers[i].ris;
+            case 0x020:
+                return timers[i].ris & REG(timerBase[i] + 0x018);
+            case 0x048:
+                return timers[i].tar;
+            case 0x050:
+                return i == 0 ? (uint32_t) now : timers[i].tar;
+            }
+        }
+    }
+    switch (a)
+    {
+    case UDMA_BASE + 0x028:
+        return udmaEnabled;
+    case UDMA_BASE + 0x504:
+        return udmaChis;
+    case 0x400AF010:
+        return eeprom[REG(0x400AF004) & 31][REG(0x400AF008) & 15];
+    case 0x400AF018:
+    case 0x400AF01C:
+    case 0x400FD008:
+        return 0;
+    case 0x400073FC:
+        return (REG(a) & ~0x40) | ((jumper ? lineAtCycle(now) : 1) << 6);
+    }
+    if (a >= NVIC_BASE + 0x100 && a < NVIC_BASE + 0x114)
+    {
+        return nvicEnable[(a - NVIC_BASE - 0x100) / 4];
+    }
+    if (a >= NVIC_BASE + 0x180 && a < NVIC_BASE + 0x194)
+    {
+        return nvicEnable[(a - NVIC_BASE - 0x180) / 4];
+    }
+    return REG(a);
+}
+
+/**
+ * @brief
+ *
+ * Function to hand a written register to the model. The register already holds the written value.
+ */
+static void writeRegister(uint32_t a /**< [in] register address */, uint32_t v /**< [in] value written */)
+{
+
+    uint8_t i;
+
+    if (a >= UART0_BASE && a < UART0_BASE + SIM_UARTS * 0x1000)
+    {
+        uint8_t n = (a - UART0_BASE) >> 12;
+        uartModel* u = &uarts[n];
+        simFrame* f;
+        switch (a & 0xFFF)
+        {
+        case 0x000:
+            txWrite(n, v);
+            break;
+        case 0x004:
+            u->rsr = 0;
+            break;
+        case 0x02C:
+            if ((v & 1) && !u->brk)
+            {
+                f = &u->frames[u->frameCount % SIM_FRAMES];
+                memset(f, 0, sizeof(*f));
+                f->breakStart = now;
+                u->frameCount++;
+            }
+            else if (!(v & 1) && u->brk && (f = openFrame(n)))
+            {
+                f->breakEnd = now;
+            }
+            u->brk = v & 1;
+            txStart(n);
+            break;
+        case 0x030:
+            txStart(n);
+            break;
+        case 0x044:
+            u->ris &= ~v;
+            break;
+        }
+        return;
+    }
+    for (i = 0; i < TIMERS; ++i)
+    {
+        if (a >= timerBase[i] && a < timerBase[i] + 0x1000)
+        {
+            timerModel* t = &timers[i];
+            bool capture = (REG(timerBase[i] + 0x004) & 3) == 3;
+            switch (a & 0xFFF)
+            {
+            case 0x00C:
+                if ((v & 1) && !t->running)
+                {
+                    t->running = true;
+                    t->expire = now + (t->remaining ? t->remaining : REG(timerBase[i] + 0x028));
+                }
+                else if (!(v & 1) && t->running)
+                {
+                    t->running = false;
+                    t->remaining = capture ? 0 : t->expire - now;
+                }
+                break;
+            case 0x024:
+                t->ris &= ~v;
+                break;
+            case 0x028:
+                t->remaining = v;
+                if (t->running)
+                {
+                    t->expire = now + v;
+                }
+                break;
+            }
+            return;
+        }
+    }
+    switch (a)
+    {
+    case UDMA_BASE + 0x028:
+        udmaEnabled |= v;
+        break;
+    case UDMA_BASE + 0x02C:
+        udmaEnabled &= ~v;
+        break;
+    case UDMA_BASE + 0x504:
+        udmaChis &= ~v;
+        break;
+    case 0x400AF010:
+        eeprom[REG(0x400AF004) & 31][REG(0x400AF008) & 15] = v;
+        break;
+    case 0x400FD008:
+        if ((v & 0xFFFF0000) == 0xA4420000)
+        {
+            uint32_t fma = REG(0x400FD000);
+            if (fma >= FLASH_BASE && fma < FLASH_BASE + FLASH_SIZE)
+            {
+                if (v & 1)
+                {
+                    *(uint32_t*) (uintptr_t) (fma & ~3) = REG(0x400FD004);
+                    flashBusy = FLASH_PROGRAM;
+                }
+                if (v & 2)
+                {
+                    memset((void*) (uintptr_t) (fma & ~0x3FF), 0xFF, 0x400);
+                    flashBusy = FLASH_ERASE;
+                }
+            }
+        }
+        break;
+    case NVIC_BASE + 0xF00:
+        if (v + 16 < VECTORS)
+        {
+            swPending[v + 16] = true;
+        }
+        break;
+    }
+    if (a >= NVIC_BASE + 0x100 && a < NVIC_BASE + 0x114)
+    {
+        nvicEnable[(a - NVIC_BASE - 0x100) / 4] |= v;
+        REG(a) = nvicEnable[(a - NVIC_BASE - 0x100) / 4];
+    }
+    if (a >= NVIC_BASE + 0x180 && a < NVIC_BASE + 0x194)
+    {
+        nvicEnable[(a - NVIC_BASE - 0x180) / 4] &= ~v;
+        REG(a) = nvicEnable[(a - NVIC_BASE - 0x180) / 4];
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to read a byte for the uDMA controller, from a register or from memory.
+ */
+static uint8_t busRead(uint32_t a /**< [in] address */)
+{
+
+    if (a >= PERIPH_BASE && a < PERIPH_BASE + PERIPH_SIZE)
+    {
+        return readRegister(a & ~3);
+    }
+    return *(uint8_t*) (uintptr_t) a;
+}
+
+/**
+ * @brief
+ *
+ * Function to write a byte for the uDMA controller, to a register or to memory.
+ */
+static void busWrite(uint32_t a /**< [in] address */, uint8_t c /**< [in] byte */)
+{
+
+    if (a >= PERIPH_BASE && a < PERIPH_BASE + PERIPH_SIZE)
+    {
+        REG(a & ~3) = c;
+        writeRegister(a & ~3, c);
+        return;
+    }
+    *(uint8_t*) (uintptr_t) a = c;
+}
+
+/**
+ * @brief
+ *
+ * Function to move one item of a basic mode uDMA channel. The control word counts the items left minus one,
+ * the next item is that many items before the end pointers. Completion stops the channel and pends UART1.
+ */
+static void udmaItem(uint8_t ch /**< [in] channel */)
+{
+
+    uint32_t* control = (uint32_t*) (uintptr_t) (REG(UDMA_BASE + 0x008) + ch * 16);
+    uint32_t word = control[2];
+    uint32_t left = (word >> 4) & 0x3FF;
+    uint32_t srcInc = (word >> 26) & 3;
+    uint32_t dstInc = (word >> 30) & 3;
+    uint32_t src = control[0] - (srcInc == 3 ? 0 : left << srcInc);
+    uint32_t dst = control[1] - (dstInc == 3 ? 0 : left << dstInc);
+
+    if ((word & 7) != 1)
+    {
+        udmaEnabled &= ~(1 << ch);
+        return;
+    }
+    busWrite(dst, busRead(src));
+    if (left == 0)
+    {
+        control[2] = word & ~7;
+        udmaEnabled &= ~(1 << ch);
+        udmaChis |= 1 << ch;
+        uarts[1].dmaDone = true;
+    }
+    else
+    {
+        control[2] = (word & ~0x3FF0) | ((left - 1) << 4);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to serve the UART1 uDMA requests. Transmit requests while the FIFO has room, receive requests while
+ * the FIFO has characters. With DMAERR, receive requests stop at a character with an error until it is cleared.
+ */
+static void udmaService()
+{
+
+    uartModel* u = &uarts[1];
+    uint32_t dmactl = REG(UART0_BASE + 0x1000 + 0x048);
+
+    while ((udmaEnabled & (1 << UDMA_TX)) && (dmactl & 2) && u->txCount < fifoDepth(1))
+    {
+        udmaItem(UDMA_TX);
+    }
+    while ((udmaEnabled & (1 << UDMA_RX)) && (dmactl & 1) && u->rxCount > 0)
+    {
+        if ((dmactl & 4) && ((u->ris & 0x780) || (u->rx[u->rxHead] & 0xF00)))
+        {
+            break;
+        }
+        udmaItem(UDMA_RX);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to tell whether an interrupt source asks for its vector.
+ */
+static bool pending(uint8_t v /**< [in] vector */)
+{
+
+    uint8_t i;
+
+    if (swPending[v])
+    {
+        return true;
+    }
+    for (i = 0; i < SIM_UARTS; ++i)
+    {
+        if (uartVector[i] == v)
+        {
+            return (uarts[i].ris & REG(UART0_BASE + i * 0x1000 + 0x038)) || uarts[i].dmaDone;
+        }
+    }
+    for (i = 0; i < TIMERS; ++i)
+    {
+        if (timerVector[i] == v)
+        {
+            return timers[i].ris & REG(timerBase[i] + 0x018);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief
+ *
+ * Function to run the pending enabled handlers, highest priority (lowest value) first, until none is pending.
+ */
+static void dispatch()
+{
+
+    uint32_t guard = 0;
+
+    udmaService();
+    for (;;)
+    {
+        int best = -1;
+        uint8_t bestPriority = 8;
+        uint8_t v;
+        uint8_t i;
+        for (v = 16; v < VECTORS; ++v)
+        {
+            uint8_t priority = (*(volatile uint8_t*) (alias + PERIPH_SIZE + 0x400 + v - 16)) >> 5;
+            if (vectors[v] && (nvicEnable[(v - 16) / 32] & (1u << ((v - 16) % 32))) && priority < bestPriority
+                    && pending(v))
+            {
+                best = v;
+                bestPriority = priority;
+            }
+        }
+        if (best < 0)
+        {
+            return;
+        }
+        if (++guard > 1000000)
+        {
+            fprintf(stderr, "interrupt %d is never cleared\n", best);
+            abort();
+        }
+        swPending[best] = false;
+        for (i = 0; i < SIM_UARTS; ++i)
+        {
+            if (uartVector[i] == best)
+            {
+                simFrame* f = openFrame(i);
+                uarts[i].dmaDone = false;
+                if (f)
+                {
+                    f->isrs++;
+                }
+            }
+        }
+        isrCount[best]++;
+        vectors[best]();
+        udmaService();
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to run the UART1 receiver on the line script up to the current cycle: find the start bit, sample the
+ * data bits and the first stop bit in the middle, push the character. A low stop bit is a framing error, and with
+ * all data bits low a break, after which the receiver waits for the line to go high.
+ */
+static uint64_t rxEvent(bool run /**< [in] act on an event due now */)
+{
+
+    uint64_t t;
+    uint8_t c = 0;
+    uint8_t b;
+
+    if (rxState == 0)
+    {
+        t = lineAtCycle(rxFrom) ? lineChange(rxFrom, 0) : rxFrom;
+        if (run && t <= now)
+        {
+            rxStart = t;
+            rxState = 1;
+            return rxEvent(false);
+        }
+        return t;
+    }
+    if (rxState == 1)
+    {
+        t = rxStart + DMX_BIT * 19 / 2;
+        if (run && t <= now)
+        {
+            for (b = 0; b < 8; ++b)
+            {
+                c |= lineAtCycle(rxStart + DMX_BIT * (2 * b + 3) / 2) << b;
+            }
+            rxFrom = t;
+            rxState = 0;
+            if ((REG(UART0_BASE + 0x1000 + 0x030) & 0x201) == 0x201)
+            {
+                rxPush(1, c | (lineAtCycle(t) ? 0 : (c ? 0x100 : 0x500)));
+            }
+            if (!lineAtCycle(t))
+            {
+                rxState = 2;
+            }
+        }
+        return t;
+    }
+    t = lineChange(rxFrom, 1);
+    if (run && t <= now)
+    {
+        rxFrom = t;
+        rxState = 0;
+        return rxEvent(false);
+    }
+    return t;
+}
+
+/**
+ * @brief
+ *
+ * Function to give the cycle of the next event of the model, UINT64_MAX for none.
+ */
+static uint64_t nextEvent()
+{
+
+    uint64_t next = UINT64_MAX;
+    uint64_t t;
+    uint8_t i;
+
+    for (i = 0; i < SIM_UARTS; ++i)
+    {
+        if (uarts[i].shifting && uarts[i].shiftEnd < next)
+        {
+            next = uarts[i].shiftEnd;
+        }
+        if (uarts[i].rxCount && !(uarts[i].ris & 0x40) && uarts[i].rtDeadline < next)
+        {
+            next = uarts[i].rtDeadline;
+        }
+    }
+    for (i = 0; i < TIMERS; ++i)
+    {
+        if (timers[i].running && (REG(timerBase[i] + 0x004) & 3) != 3 && timers[i].expire < next)
+        {
+            next = timers[i].expire;
+        }
+    }
+    if (consoleInHead != consoleInTail && consoleInNext < next)
+    {
+        next = consoleInNext;
+    }
+    if (lineNext < lineEdges && lineAt[lineNext] < next)
+    {
+        next = lineAt[lineNext];
+    }
+    t = rxEvent(false);
+    return t < next ? t : next;
+}
+
+/**
+ * @brief
+ *
+ * Function to act on every event due at the current cycle.
+ */
+static void runEvents()
+{
+
+    uint8_t i;
+
+    for (i = 0; i < SIM_UARTS; ++i)
+    {
+        uartModel* u = &uarts[i];
+        if (u->shifting && u->shiftEnd <= now)
+        {
+            simFrame* f = openFrame(i);
+            u->shifting = false;
+            if (f && f->count)
+            {
+                f->dataEnd = now;
+            }
+            txStart(i);
+            if (!u->shifting && (REG(UART0_BASE + i * 0x1000 + 0x030) & 0x10))
+            {
+                u->ris |= 0x20;
+            }
+        }
+        if (u->rxCount && !(u->ris & 0x40) && u->rtDeadline <= now)
+        {
+            u->ris |= 0x40;
+        }
+    }
+    for (i = 0; i < TIMERS; ++i)
+    {
+        timerModel* t = &timers[i];
+        uint32_t mode = REG(timerBase[i] + 0x004) & 3;
+        if (t->running && mode != 3 && t->expire <= now)
+        {
+            t->ris |= 0x01;
+            if (mode == 2)
+            {
+                t->expire += REG(timerBase[i] + 0x028) ? REG(timerBase[i] + 0x028) : 1;
+            }
+            else
+            {
+                t->running = false;
+                t->remaining = 0;
+                REG(timerBase[i] + 0x00C) &= ~1;
+            }
+        }
+    }
+    if (consoleInHead != consoleInTail && consoleInNext <= now)
+    {
+        rxPush(0, (uint8_t) consoleIn[consoleInHead++]);
+        consoleInNext = now + charCycles(0);
+    }
+    while (lineNext < lineEdges && lineAt[lineNext] <= now)
+    {
+        //Wide Timer 5 captures both edges of PD6
+        if (jumper && timers[4].running && (REG(timerBase[4] + 0x004) & 3) == 3)
+        {
+            timers[4].tar = (uint32_t) lineAt[lineNext];
+            timers[4].ris |= 0x04;
+        }
+        lineNext++;
+    }
+    while (rxEvent(false) <= now)
+    {
+        rxEvent(true);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to let the peripherals run through a flash erase or program. Instructions are fetched from flash,
+ * so no handler runs until it is done.
+ */
+static void stall()
+{
+
+    uint64_t end = now + flashBusy;
+    uint64_t next;
+
+    flashBusy = 0;
+    while ((next = nextEvent()) <= end)
+    {
+        if (next > now)
+        {
+            now = next;
+        }
+        runEvents();
+    }
+    now = end;
+}
+
+/**
+ * @brief
+ *
+ * Function to emulate a faulting register access. Reads get the register value first, then the access is single
+ * stepped on the opened page.
+ */
+static void onFault(int sig, siginfo_t* info, void* context)
+{
+
+    ucontext_t* uc = context;
+    uintptr_t a = (uintptr_t) info->si_addr;
+    bool periph = a >= PERIPH_BASE && a < PERIPH_BASE + PERIPH_SIZE;
+
+    if (trapping || !(periph || (a >= NVIC_BASE && a < NVIC_BASE + PAGE)))
+    {
+        //a real fault, crash on it
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+    trapAddress = a & ~3;
+    trapWrite = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+    if (!trapWrite)
+    {
+        REG(trapAddress) = readRegister(trapAddress);
+    }
+    mprotect((void*) (a & ~(uintptr_t) (PAGE - 1)), PAGE, PROT_READ | PROT_WRITE);
+    trapping = true;
+    uc->uc_mcontext.gregs[REG_EFL] |= 0x100;
+}
+
+/**
+ * @brief
+ *
+ * Function to close the page again after the single stepped access and hand a write to the model.
+ */
+static void onTrap(int sig, siginfo_t* info, void* context)
+{
+
+    ucontext_t* uc = context;
+
+    if (!trapping)
+    {
+        signal(SIGTRAP, SIG_DFL);
+        return;
+    }
+    uc->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+    mprotect((void*) (uintptr_t) (trapAddress & ~(PAGE - 1)), PAGE, PROT_NONE);
+    trapping = false;
+    if (trapWrite)
+    {
+        writeRegister(trapAddress, REG(trapAddress));
+    }
+    if (flashBusy)
+    {
+        stall();
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to map the peripherals and install the fault handlers. Call before initHw.
+ */
+void simInit()
+{
+
+    struct sigaction sa;
+    int fd = memfd_create("tm4c123gh6pm", 0);
+    uint8_t* bitband;
+    uint8_t i;
+
+    if (fd < 0 || ftruncate(fd, PERIPH_SIZE + PAGE) < 0)
+    {
+        perror("memfd");
+        exit(1);
+    }
+    alias = mmap(0, PERIPH_SIZE + PAGE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (alias == MAP_FAILED
+            || mmap((void*) PERIPH_BASE, PERIPH_SIZE, PROT_NONE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0)
+                    != (void*) PERIPH_BASE
+            || mmap((void*) NVIC_BASE, PAGE, PROT_NONE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, PERIPH_SIZE)
+                    != (void*) NVIC_BASE)
+    {
+        perror("mmap peripherals");
+        exit(1);
+    }
+    bitband = mmap((void*) BITBAND_BASE, PAGE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (bitband != (void*) BITBAND_BASE
+            || mmap((void*) FLASH_BASE, FLASH_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void*) FLASH_BASE)
+    {
+        perror("mmap memory");
+        exit(1);
+    }
+    memset((void*) FLASH_BASE, 0xFF, FLASH_SIZE);
+    memset(eeprom, 0xFF, sizeof(eeprom));
+
+    //push buttons read released
+    for (i = 0; i < 8; ++i)
+    {
+        ((volatile uint32_t*) (bitband + 0xF80))[i] = (i == 0 || i == 4);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sa.sa_sigaction = onFault;
+    sigaction(SIGSEGV, &sa, 0);
+    sa.sa_sigaction = onTrap;
+    sigaction(SIGTRAP, &sa, 0);
+}
+
+/**
+ * @brief
+ *
+ * Function to install an interrupt handler.
+ */
+void simVector(uint8_t n /**< [in] vector number, INT_ value */, void (*isr)() /**< [in] handler */)
+{
+
+    vectors[n] = isr;
+}
+
+/**
+ * @brief
+ *
+ * Function to set what the main loop does while time passes, 0 for nothing.
+ */
+void simIdle(void (*idle)() /**< [in] main loop pass */)
+{
+
+    idleHook = idle;
+}
+
+/**
+ * @brief
+ *
+ * Function to let time pass. Events are acted on in order, pending handlers run after each of them.
+ */
+void simRun(uint32_t us /**< [in] time to run, in microseconds */)
+{
+
+    uint64_t end = now + (uint64_t) us * 40;
+    uint64_t next;
+
+    for (;;)
+    {
+        dispatch();
+        if (idleHook)
+        {
+            idleHook();
+            dispatch();
+        }
+        next = nextEvent();
+        if (next > end)
+        {
+            //a WFI in the main loop may have run past the end already
+            if (end > now)
+            {
+                now = end;
+            }
+            return;
+        }
+        if (next > now)
+        {
+            now = next;
+        }
+        runEvents();
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to run the inline assembly of the firmware. Only WFI does something: time passes up to the next event
+ * and the handlers it pends run, without another main loop pass.
+ */
+void simAsm(const char* code /**< [in] assembly text */)
+{
+
+    uint64_t next;
+
+    if (!strstr(code, "WFI"))
+    {
+        return;
+    }
+    next = nextEvent();
+    if (next == UINT64_MAX)
+    {
+        fprintf(stderr, "WFI with nothing left to happen\n");
+        abort();
+    }
+    if (next > now)
+    {
+        now = next;
+    }
+    runEvents();
+    dispatch();
+}
+
+/**
+ * @brief
+ *
+ * Function to give the current cycle.
+ */
+uint64_t simNow()
+{
+
+    return now;
+}
+
+/**
+ * @brief
+ *
+ * Function to preset an EEPROM word, like a previous run left it.
+ */
+void simEeprom(uint8_t block /**< [in] block */, uint8_t offset /**< [in] offset */, uint32_t value /**< [in] word */)
+{
+
+    eeprom[block & 31][offset & 15] = value;
+}
+
+/**
+ * @brief
+ *
+ * Function to type a console line on UART0 at 115200 baud and run until the main loop has taken it.
+ */
+void simConsole(const char* line /**< [in] command without the return */)
+{
+
+    uint16_t length = strlen(line);
+
+    if (consoleInHead == consoleInTail)
+    {
+        consoleInHead = consoleInTail = 0;
+    }
+    memcpy(consoleIn + consoleInTail, line, length);
+    consoleInTail += length;
+    consoleIn[consoleInTail++] = '\r';
+    consoleInNext = now;
+    simRun((length + 1) * 87 + 1000);
+}
+
+/**
+ * @brief
+ *
+ * Function to give the console output since the last simConsoleClear.
+ */
+const char* simConsoleOut()
+{
+
+    return consoleOut;
+}
+
+/**
+ * @brief
+ *
+ * Function to forget the console output.
+ */
+void simConsoleClear()
+{
+
+    consoleLength = 0;
+    consoleOut[0] = 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to give the number of breaks a UART sent since its log was cleared.
+ */
+uint16_t simFrameCount(uint8_t uart /**< [in] UART */)
+{
+
+    return uarts[uart].frameCount;
+}
+
+/**
+ * @brief
+ *
+ * Function to give a logged frame of a UART, counted from 0 at the last clear. Only the last SIM_FRAMES are kept.
+ */
+const simFrame* simFrameAt(uint8_t uart /**< [in] UART */, uint16_t i /**< [in] frame */)
+{
+
+    uartModel* u = &uarts[uart];
+
+    if (i >= u->frameCount || i + SIM_FRAMES < u->frameCount)
+    {
+        return 0;
+    }
+    return &u->frames[i % SIM_FRAMES];
+}
+
+/**
+ * @brief
+ *
+ * Function to forget the transmit log of a UART.
+ */
+void simFramesClear(uint8_t uart /**< [in] UART */)
+{
+
+    uarts[uart].frameCount = 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to add a level to the receive line script, after the script so far or from now on.
+ */
+static void lineHold(uint8_t level /**< [in] line level */, uint64_t cycles /**< [in] duration */)
+{
+
+    uint64_t t = lineTail > now ? lineTail : now;
+    uint8_t last = lineEdges ? lineLevel[lineEdges - 1] : 1;
+
+    if (level != last && lineEdges < LINE_EDGES)
+    {
+        lineAt[lineEdges] = t;
+        lineLevel[lineEdges] = level;
+        lineEdges++;
+    }
+    lineTail = t + cycles;
+}
+
+/**
+ * @brief
+ *
+ * Function to hold the receive line idle (mark).
+ */
+void simLineIdle(uint32_t us /**< [in] duration in microseconds */)
+{
+
+    lineHold(1, (uint64_t) us * 40);
+}
+
+/**
+ * @brief
+ *
+ * Function to hold the receive line low (break).
+ */
+void simLineBreak(uint32_t us /**< [in] duration in microseconds */)
+{
+
+    lineHold(0, (uint64_t) us * 40);
+}
+
+/**
+ * @brief
+ *
+ * Function to send one 8N2 character at 250 kbaud on the receive line.
+ */
+void simLineByte(uint8_t c /**< [in] character */)
+{
+
+    uint8_t b;
+
+    lineHold(0, DMX_BIT);
+    for (b = 0; b < 8; ++b)
+    {
+        lineHold((c >> b) & 1, DMX_BIT);
+    }
+    lineHold(1, 2 * DMX_BIT);
+}
+
+/**
+ * @brief
+ *
+ * Function to send one character with a low stop bit on the receive line, a framing error.
+ */
+void simLineBadStop(uint8_t c /**< [in] character, not 0 so it is not a break */)
+{
+
+    uint8_t b;
+
+    lineHold(0, DMX_BIT);
+    for (b = 0; b < 8; ++b)
+    {
+        lineHold((c >> b) & 1, DMX_BIT);
+    }
+    lineHold(0, DMX_BIT);
+    lineHold(1, DMX_BIT);
+}
+
+/**
+ * @brief
+ *
+ * Function to connect or disconnect the PD6 jumper. Disconnected, PD6 reads high from its pull-up.
+ */
+void simLineJumper(bool on /**< [in] true when jumpered to U1RX */)
+{
+
+    jumper = on;
+}
+
+/**
+ * @brief
+ *
+ * Function to run until the receive line script has been played, and some time after it.
+ */
+void simLineRun(uint32_t us /**< [in] time to run after the script, in microseconds */)
+{
+
+    uint64_t end = (lineTail > now ? lineTail : now) + (uint64_t) us * 40;
+
+    simRun((end - now) / 40);
+}
+
+/**
+ * @brief
+ *
+ * Function to give the number of times a handler ran.
+ */
+uint32_t simIsrCount(uint8_t n /**< [in] vector number */)
+{
+
+    return isrCount[n];
+}
@@ -0,0 +1,57 @@
+/**
+ * @file double.h
+ * @brief Linux test double of the TM4C123GH6PM peripherals used by satej_matthew.c. <br>
+ * The register pages are mapped at their real addresses with no access, every firmware access faults and is
+ * emulated: UARTs with FIFOs, break and error flags, uDMA basic mode, general purpose timers, edge capture,
+ * EEPROM, flash and the NVIC. Interrupt handlers are run one after the other from simRun(), never nested,
+ * in priority order. Time only advances in simRun(), at 40 MHz. <br>
+ * Build with -no-pie so the firmware globals have 32-bit addresses, like the uDMA control table expects.
+ */
+
+#ifndef DOUBLE_H
+#define DOUBLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_UARTS 8 /*!< UART0 to UART7. */
+
+#define SIM_FRAMES 16 /*!< Frames kept in the transmit log of each UART. */
+
+#define SIM_FRAME_BYTES 600 /*!< Characters kept per logged frame. */
+
+/**
+ * Frame seen on the transmit line of a UART, from one break to the next.
+ */
+typedef struct
+{
+    uint64_t breakStart; /*!< Cycle the break started at. */
+    uint64_t breakEnd; /*!< Cycle the break ended at, the start of the mark after break. */
+    uint64_t dataStart; /*!< Cycle the start bit of the first character started at. */
+    uint64_t dataEnd; /*!< Cycle the stop bits of the last character ended at. */
+    uint32_t isrs; /*!< Interrupts of the UART taken from the break to the next break. */
+    uint16_t count; /*!< Characters sent after the break. */
+    uint8_t data[SIM_FRAME_BYTES]; /*!< First characters sent after the break. */
+} simFrame;
+
+void simInit();
+void simVector(uint8_t n, void (*isr)());
+void simIdle(void (*idle)());
+void simRun(uint32_t us);
+uint64_t simNow();
+void simEeprom(uint8_t block, uint8_t offset, uint32_t value);
+void simConsole(const char* line);
+const char* simConsoleOut();
+void simConsoleClear();
+uint16_t simFrameCount(uint8_t uart);
+const simFrame* simFrameAt(uint8_t uart, uint16_t i);
+void simFramesClear(uint8_t uart);
+void simLineIdle(uint32_t us);
+void simLineBreak(uint32_t us);
+void simLineByte(uint8_t c);
+void simLineBadStop(uint8_t c);
+void simLineJumper(bool on);
+void simLineRun(uint32_t us);
+uint32_t simIsrCount(uint8_t n);
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * @file rx_test.c
+ * @brief Host test of the UART1 receive engines against the peripheral double. <br>
+ * The same DMX line is played to rxmode 1 (uDMA) and rxmode 0 (interrupt per FIFO level): full and short frames,
+ * a framing error, an alternate start code, a frame under 24 slots and a break too short for the Wide Timer 5
+ * capture. Checks what reaches the front universe, the receive statistics and the UART1 interrupts per frame.
+ */
+
+#define main firmwareMain
+#include "../../satej_matthew.c"
+#undef main
+
+#include <stdio.h>
+#include "double.h"
+
+int checks = 0; /*!< Checks made. */
+int failures = 0; /*!< Checks failed. */
+
+#define CHECK(c) check((c), #c, __LINE__)
+
+/**
+ * @brief
+ *
+ * Function to count a check and report it when it fails.
+ */
+void check(bool ok /**< [in] result */, const char* what /**< [in] checked expression */, int line /**< [in] source line */)
+{
+
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        fprintf(stderr, "rx_test.c:%d: failed: %s\n", line, what);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to start the firmware in device mode, the way main() does after a reset.
+ */
+void boot()
+{
+
+    simInit();
+    simVector(INT_UART0, Uart0Isr);
+    simVector(INT_UART1, Uart1Isr);
+    simVector(INT_UART2, Uart2Isr);
+    simVector(INT_UART3, Uart3Isr);
+    simVector(INT_UART5, Uart5Isr);
+    simVector(INT_UART6, Uart6Isr);
+    simVector(INT_UART7, Uart7Isr);
+    simVector(INT_TIMER1A, Timer1ISR);
+    simVector(INT_TIMER2A, Timer2ISR);
+    simVector(INT_TIMER3A, Timer3ISR);
+    simVector(INT_WTIMER5A, WideTimer5ISR);
+    simIdle(serviceConsole);
+    simEeprom(0, 2, 0);
+    initHw();
+    getModeEE();
+    simConsole("device");
+}
+
+/**
+ * @brief
+ *
+ * Function to play one frame on the receive line: break, mark after break, start code and slots.
+ * The levels are i * 3 + seed. A slot can be sent with a low stop bit.
+ */
+void sendFrame(uint16_t breakUs /**< [in] break duration */, uint8_t startCode /**< [in] start code */,
+               uint16_t slots /**< [in] number of slots */, uint8_t seed /**< [in] level seed */,
+               int16_t badStop /**< [in] slot with a framing error, -1 for none */)
+{
+
+    uint16_t i;
+
+    simLineBreak(breakUs);
+    simLineIdle(12);
+    simLineByte(startCode);
+    for (i = 0; i < slots; ++i)
+    {
+        if (i == badStop)
+        {
+            simLineBadStop(0xFF);
+        }
+        else
+        {
+            simLineByte(i * 3 + seed);
+        }
+    }
+    simLineIdle(20);
+}
+
+/**
+ * @brief
+ *
+ * Function to end the frame on the line with the next break and let the receiver take it.
+ */
+void settle()
+{
+
+    simLineBreak(176);
+    simLineIdle(100);
+    simLineRun(100);
+}
+
+/**
+ * @brief
+ *
+ * Function to tell whether the front universe holds a frame of the given slots and seed, the rest 0.
+ */
+bool frontIs(uint16_t slots /**< [in] number of slots */, uint8_t seed /**< [in] level seed */)
+{
+
+    uint16_t i;
+
+    for (i = 0; i < 512; ++i)
+    {
+        if (dmxFront[i] != (i < slots ? (uint8_t) (i * 3 + seed) : 0))
+        {
+            return false;
+        }
+    }
+    return dmxFront[-1] == 0;
+}
+
+/**
+ * @brief
+ *
+ * Function to play every case to the selected receive engine.
+ */
+void runMode(uint8_t m /**< [in] receive mode */)
+{
+
+    rxStatistics s;
+    char line[20];
+
+    sprintf(line, "rxmode %u", m);
+    simConsole(line);
+    simLineJumper(true);
+
+    //two full frames, the second one shows the interrupts of a frame in steady state
+    sendFrame(176, 0, 512, 1, -1);
+    sendFrame(176, 0, 512, 2, -1);
+    settle();
+    s = rxStats;
+    CHECK(frontIs(512, 2));
+    CHECK(rxStats.slots == 512);
+    if (m == 1)
+    {
+        //break and end of transfer
+        CHECK(rxIsrPerFrame == 2);
+    }
+    else
+    {
+        //at least one per 8 characters
+        CHECK(rxIsrPerFrame >= 513 / 8);
+    }
+    printf("rxmode %u: %u UART1 interrupts per 512 slot frame\n", m, rxIsrPerFrame);
+
+    //short frame, committed at the next break with the missing slots 0
+    sendFrame(176, 0, 100, 3, -1);
+    settle();
+    CHECK(rxStats.frames == s.frames + 1);
+    CHECK(rxStats.slots == 100);
+    CHECK(frontIs(100, 3));
+    s = rxStats;
+
+    //framing error in the middle of the frame
+    sendFrame(176, 0, 512, 4, 50);
+    settle();
+    CHECK(rxStats.frames == s.frames);
+    CHECK(rxStats.framingErrors == s.framingErrors + 1);
+    CHECK(rxStats.dropped == s.dropped + 1);
+    CHECK(frontIs(100, 3));
+    s = rxStats;
+
+    //alternate start code
+    sendFrame(176, 0xCC, 512, 5, -1);
+    settle();
+    CHECK(rxStats.frames == s.frames);
+    CHECK(rxStats.startCodes == s.startCodes + 1);
+    CHECK(frontIs(100, 3));
+    s = rxStats;
+
+    //fewer than 24 slots
+    sendFrame(176, 0, 10, 6, -1);
+    settle();
+    CHECK(rxStats.frames == s.frames);
+    CHECK(rxStats.dropped == s.dropped + 1);
+    CHECK(frontIs(100, 3));
+    s = rxStats;
+
+    //60 us break, long enough for the UART but out of spec on the capture
+    sendFrame(60, 0, 512, 7, -1);
+    settle();
+    CHECK(rxStats.frames == s.frames);
+    CHECK(rxStats.badBreaks == s.badBreaks + 1);
+    CHECK(frontIs(100, 3));
+    s = rxStats;
+
+    //good frames again
+    sendFrame(176, 0, 300, 8, -1);
+    settle();
+    CHECK(rxStats.frames == s.frames + 1);
+    CHECK(rxStats.framingErrors == s.framingErrors);
+    CHECK(rxStats.dropped == s.dropped);
+    CHECK(frontIs(300, 8));
+    CHECK(rxWriting == (m == 1));
+    CHECK(ports[0].writing == rxWriting);
+}
+
+/**
+ * @brief
+ *
+ * Function to run the receive tests.
+ */
+int main()
+{
+
+    boot();
+    runMode(1);
+    runMode(0);
+    printf("rx_test: %d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,381 @@
+/*
+ * Host build stand-in for the TI tm4c123gh6pm.h header.
+ *
+ * Only the registers and fields satej_matthew.c uses are listed. Addresses and
+ * field values are the ones of the TM4C123GH6PM data sheet, so the firmware
+ * compiles unchanged; the register pages are mapped and emulated by double.c.
+ * Inline assembly (interrupt masking, NOPs, waitMicrosecond) and the TI BASEPRI
+ * intrinsic do nothing; the double never preempts the main loop. A WFI lets the
+ * double run up to its next event and the handlers it pends.
+ */
+
+#ifndef TM4C123GH6PM_SIM_H
+#define TM4C123GH6PM_SIM_H
+
+void simAsm(const char* code);
+
+#define __asm(x) simAsm(x)
+
+static inline uint32_t _set_interrupt_priority(uint32_t priority)
+{
+    (void) priority;
+    return 0;
+}
+
+#define SIM_REG(a) (*((volatile uint32_t *)(a)))
+
+//-----------------------------------------------------------------------------
+// Interrupt numbers (vector table index)
+//-----------------------------------------------------------------------------
+#define INT_UART0               21
+#define INT_UART1               22
+#define INT_TIMER1A             37
+#define INT_TIMER2A             39
+#define INT_UART2               49
+#define INT_TIMER3A             51
+#define INT_UART3               75
+#define INT_UART5               77
+#define INT_UART6               78
+#define INT_UART7               79
+#define INT_WTIMER5A            120
+
+//-----------------------------------------------------------------------------
+// UART registers
+//-----------------------------------------------------------------------------
+#define UART0_DR_R              SIM_REG(0x4000C000)
+#define UART0_FR_R              SIM_REG(0x4000C018)
+#define UART0_IBRD_R            SIM_REG(0x4000C024)
+#define UART0_FBRD_R            SIM_REG(0x4000C028)
+#define UART0_LCRH_R            SIM_REG(0x4000C02C)
+#define UART0_CTL_R             SIM_REG(0x4000C030)
+#define UART0_IFLS_R            SIM_REG(0x4000C034)
+#define UART0_IM_R              SIM_REG(0x4000C038)
+#define UART0_MIS_R             SIM_REG(0x4000C040)
+#define UART0_ICR_R             SIM_REG(0x4000C044)
+#define UART0_CC_R              SIM_REG(0x4000CFC8)
+
+#define UART1_DR_R              SIM_REG(0x4000D000)
+#define UART1_RSR_R             SIM_REG(0x4000D004)
+#define UART1_ECR_R             SIM_REG(0x4000D004)
+#define UART1_FR_R              SIM_REG(0x4000D018)
+#define UART1_IBRD_R            SIM_REG(0x4000D024)
+#define UART1_FBRD_R            SIM_REG(0x4000D028)
+#define UART1_LCRH_R            SIM_REG(0x4000D02C)
+#define UART1_CTL_R             SIM_REG(0x4000D030)
+#define UART1_IFLS_R            SIM_REG(0x4000D034)
+#define UART1_IM_R              SIM_REG(0x4000D038)
+#define UART1_MIS_R             SIM_REG(0x4000D040)
+#define UART1_ICR_R             SIM_REG(0x4000D044)
+#define UART1_DMACTL_R          SIM_REG(0x4000D048)
+#define UART1_CC_R              SIM_REG(0x4000DFC8)
+
+#define UART7_DR_R              SIM_REG(0x40013000)
+#define UART7_RSR_R             SIM_REG(0x40013004)
+#define UART7_ECR_R             SIM_REG(0x40013004)
+#define UART7_FR_R              SIM_REG(0x40013018)
+#define UART7_CTL_R             SIM_REG(0x40013030)
+#define UART7_IFLS_R            SIM_REG(0x40013034)
+#define UART7_IM_R              SIM_REG(0x40013038)
+#define UART7_MIS_R             SIM_REG(0x40013040)
+#define UART7_ICR_R             SIM_REG(0x40013044)
+
+#define UART_DR_OE              0x00000800
+#define UART_DR_BE              0x00000400
+#define UART_DR_PE              0x00000200
+#define UART_DR_FE              0x00000100
+#define UART_RSR_OE             0x00000008
+#define UART_RSR_BE             0x00000004
+#define UART_RSR_FE             0x00000001
+#define UART_FR_TXFE            0x00000080
+#define UART_FR_RXFF            0x00000040
+#define UART_FR_TXFF            0x00000020
+#define UART_FR_RXFE            0x00000010
+#define UART_FR_BUSY            0x00000008
+#define UART_LCRH_WLEN_8        0x00000060
+#define UART_LCRH_FEN           0x00000010
+#define UART_LCRH_STP2          0x00000008
+#define UART_LCRH_BRK           0x00000001
+#define UART_CTL_RXE            0x00000200
+#define UART_CTL_TXE            0x00000100
+#define UART_CTL_EOT            0x00000010
+#define UART_CTL_UARTEN         0x00000001
+#define UART_IFLS_RX1_8         0x00000000
+#define UART_IFLS_RX2_8         0x00000008
+#define UART_IFLS_RX4_8         0x00000010
+#define UART_IFLS_RX6_8         0x00000018
+#define UART_IFLS_RX7_8         0x00000020
+#define UART_IFLS_TX1_8         0x00000000
+#define UART_IFLS_TX2_8         0x00000001
+#define UART_IFLS_TX4_8         0x00000002
+#define UART_IFLS_TX6_8         0x00000003
+#define UART_IFLS_TX7_8         0x00000004
+#define UART_IM_OEIM            0x00000400
+#define UART_IM_BEIM            0x00000200
+#define UART_IM_FEIM            0x00000080
+#define UART_IM_RTIM            0x00000040
+#define UART_IM_TXIM            0x00000020
+#define UART_IM_RXIM            0x00000010
+#define UART_MIS_OEMIS          0x00000400
+#define UART_MIS_BEMIS          0x00000200
+#define UART_MIS_FEMIS          0x00000080
+#define UART_MIS_RTMIS          0x00000040
+#define UART_MIS_TXMIS          0x00000020
+#define UART_MIS_RXMIS          0x00000010
+#define UART_ICR_OEIC           0x00000400
+#define UART_ICR_BEIC           0x00000200
+#define UART_ICR_FEIC           0x00000080
+#define UART_ICR_RTIC           0x00000040
+#define UART_ICR_TXIC           0x00000020
+#define UART_ICR_RXIC           0x00000010
+#define UART_DMACTL_DMAERR      0x00000004
+#define UART_DMACTL_TXDMAE      0x00000002
+#define UART_DMACTL_RXDMAE      0x00000001
+#define UART_CC_CS_SYSCLK       0x00000000
+
+//-----------------------------------------------------------------------------
+// GPIO registers (APB)
+//-----------------------------------------------------------------------------
+#define GPIO_PORTA_DIR_R        SIM_REG(0x40004400)
+#define GPIO_PORTA_AFSEL_R      SIM_REG(0x40004420)
+#define GPIO_PORTA_DEN_R        SIM_REG(0x4000451C)
+#define GPIO_PORTA_PCTL_R       SIM_REG(0x4000452C)
+
+#define GPIO_PORTC_DATA_R       SIM_REG(0x400063FC)
+#define GPIO_PORTC_DIR_R        SIM_REG(0x40006400)
+#define GPIO_PORTC_AFSEL_R      SIM_REG(0x40006420)
+#define GPIO_PORTC_DEN_R        SIM_REG(0x4000651C)
+#define GPIO_PORTC_PCTL_R       SIM_REG(0x4000652C)
+
+#define GPIO_PORTD_DATA_R       SIM_REG(0x400073FC)
+#define GPIO_PORTD_DIR_R        SIM_REG(0x40007400)
+#define GPIO_PORTD_AFSEL_R      SIM_REG(0x40007420)
+#define GPIO_PORTD_PUR_R        SIM_REG(0x40007510)
+#define GPIO_PORTD_DEN_R        SIM_REG(0x4000751C)
+#define GPIO_PORTD_LOCK_R       SIM_REG(0x40007520)
+#define GPIO_PORTD_CR_R         SIM_REG(0x40007524)
+#define GPIO_PORTD_PCTL_R       SIM_REG(0x4000752C)
+
+#define GPIO_PORTE_DIR_R        SIM_REG(0x40024400)
+#define GPIO_PORTE_AFSEL_R      SIM_REG(0x40024420)
+#define GPIO_PORTE_DEN_R        SIM_REG(0x4002451C)
+#define GPIO_PORTE_PCTL_R       SIM_REG(0x4002452C)
+
+#define GPIO_PORTF_DATA_R       SIM_REG(0x400253FC)
+#define GPIO_PORTF_DIR_R        SIM_REG(0x40025400)
+#define GPIO_PORTF_AFSEL_R      SIM_REG(0x40025420)
+#define GPIO_PORTF_DR2R_R       SIM_REG(0x40025500)
+#define GPIO_PORTF_PUR_R        SIM_REG(0x40025510)
+#define GPIO_PORTF_DEN_R        SIM_REG(0x4002551C)
+#define GPIO_PORTF_LOCK_R       SIM_REG(0x40025520)
+#define GPIO_PORTF_CR_R         SIM_REG(0x40025524)
+#define GPIO_PORTF_PCTL_R       SIM_REG(0x4002552C)
+
+#define GPIO_LOCK_KEY           0x4C4F434B
+#define GPIO_PCTL_PA0_U0RX      0x00000001
+#define GPIO_PCTL_PA1_U0TX      0x00000010
+#define GPIO_PCTL_PC4_U1RX      0x00020000
+#define GPIO_PCTL_PC5_U1TX      0x00200000
+#define GPIO_PCTL_PC7_U3TX      0x10000000
+#define GPIO_PCTL_PD5_U6TX      0x00100000
+#define GPIO_PCTL_PD6_WT5CCP0   0x07000000
+#define GPIO_PCTL_PD7_U2TX      0x10000000
+#define GPIO_PCTL_PE0_M         0x0000000F
+#define GPIO_PCTL_PE0_U7RX      0x00000001
+#define GPIO_PCTL_PE1_U7TX      0x00000010
+#define GPIO_PCTL_PE5_U5TX      0x00100000
+#define GPIO_PCTL_PF1_M1PWM5    0x00000050
+#define GPIO_PCTL_PF2_M1PWM6    0x00000500
+#define GPIO_PCTL_PF3_M1PWM7    0x00005000
+
+//-----------------------------------------------------------------------------
+// Timer registers
+//-----------------------------------------------------------------------------
+#define TIMER0_CFG_R            SIM_REG(0x40030000)
+#define TIMER0_TAMR_R           SIM_REG(0x40030004)
+#define TIMER0_CTL_R            SIM_REG(0x4003000C)
+#define TIMER0_TAILR_R          SIM_REG(0x40030028)
+#define TIMER0_TAV_R            SIM_REG(0x40030050)
+
+#define TIMER1_CFG_R            SIM_REG(0x40031000)
+#define TIMER1_TAMR_R           SIM_REG(0x40031004)
+#define TIMER1_CTL_R            SIM_REG(0x4003100C)
+#define TIMER1_IMR_R            SIM_REG(0x40031018)
+#define TIMER1_ICR_R            SIM_REG(0x40031024)
+#define TIMER1_TAILR_R          SIM_REG(0x40031028)
+
+#define TIMER2_IMR_R            SIM_REG(0x40032018)
+
+#define TIMER3_CFG_R            SIM_REG(0x40033000)
+#define TIMER3_TAMR_R           SIM_REG(0x40033004)
+#define TIMER3_CTL_R            SIM_REG(0x4003300C)
+#define TIMER3_IMR_R            SIM_REG(0x40033018)
+#define TIMER3_ICR_R            SIM_REG(0x40033024)
+#define TIMER3_TAILR_R          SIM_REG(0x40033028)
+
+#define WTIMER5_CFG_R           SIM_REG(0x4004F000)
+#define WTIMER5_TAMR_R          SIM_REG(0x4004F004)
+#define WTIMER5_CTL_R           SIM_REG(0x4004F00C)
+#define WTIMER5_IMR_R           SIM_REG(0x4004F018)
+#define WTIMER5_ICR_R           SIM_REG(0x4004F024)
+#define WTIMER5_TAILR_R         SIM_REG(0x4004F028)
+#define WTIMER5_TAR_R           SIM_REG(0x4004F048)
+
+#define TIMER_CFG_32_BIT_TIMER  0x00000000
+#define TIMER_CFG_16_BIT        0x00000004
+#define TIMER_TAMR_TACDIR       0x00000010
+#define TIMER_TAMR_TACMR        0x00000004
+#define TIMER_TAMR_TAMR_1_SHOT  0x00000001
+#define TIMER_TAMR_TAMR_PERIOD  0x00000002
+#define TIMER_TAMR_TAMR_CAP     0x00000003
+#define TIMER_CTL_TAEVENT_BOTH  0x0000000C
+#define TIMER_CTL_TAEN          0x00000001
+#define TIMER_IMR_CAEIM         0x00000004
+#define TIMER_IMR_TATOIM        0x00000001
+#define TIMER_ICR_CAECINT       0x00000004
+#define TIMER_ICR_TATOCINT      0x00000001
+
+//-----------------------------------------------------------------------------
+// PWM1 registers
+//-----------------------------------------------------------------------------
+#define PWM1_ENABLE_R           SIM_REG(0x40029008)
+#define PWM1_INVERT_R           SIM_REG(0x4002900C)
+#define PWM1_1_CTL_R            SIM_REG(0x40029080)
+#define PWM1_2_CTL_R            SIM_REG(0x400290C0)
+#define PWM1_2_LOAD_R           SIM_REG(0x400290D0)
+#define PWM1_2_CMPB_R           SIM_REG(0x400290DC)
+#define PWM1_2_GENB_R           SIM_REG(0x400290E4)
+#define PWM1_3_CTL_R            SIM_REG(0x40029100)
+#define PWM1_3_LOAD_R           SIM_REG(0x40029110)
+#define PWM1_3_CMPA_R           SIM_REG(0x40029118)
+#define PWM1_3_CMPB_R           SIM_REG(0x4002911C)
+#define PWM1_3_GENA_R           SIM_REG(0x40029120)
+#define PWM1_3_GENB_R           SIM_REG(0x40029124)
+
+#define PWM_ENABLE_PWM7EN       0x00000080
+#define PWM_ENABLE_PWM6EN       0x00000040
+#define PWM_ENABLE_PWM5EN       0x00000020
+#define PWM_INVERT_PWM7INV      0x00000080
+#define PWM_INVERT_PWM6INV      0x00000040
+#define PWM_INVERT_PWM5INV      0x00000020
+#define PWM_2_CTL_ENABLE        0x00000001
+#define PWM_3_CTL_ENABLE        0x00000001
+#define PWM_1_GENA_ACTCMPAD_ZERO 0x00000080
+#define PWM_1_GENA_ACTLOAD_ONE  0x0000000C
+#define PWM_1_GENB_ACTCMPBD_ZERO 0x00000800
+#define PWM_1_GENB_ACTLOAD_ONE  0x0000000C
+
+//-----------------------------------------------------------------------------
+// EEPROM and flash controller registers
+//-----------------------------------------------------------------------------
+#define EEPROM_EEBLOCK_R        SIM_REG(0x400AF004)
+#define EEPROM_EEOFFSET_R       SIM_REG(0x400AF008)
+#define EEPROM_EERDWR_R         SIM_REG(0x400AF010)
+#define EEPROM_EEDONE_R         SIM_REG(0x400AF018)
+#define EEPROM_EESUPP_R         SIM_REG(0x400AF01C)
+#define EEPROM_EESUPP_PRETRY    0x00000008
+#define EEPROM_EESUPP_ERETRY    0x00000004
+
+#define FLASH_FMA_R             SIM_REG(0x400FD000)
+#define FLASH_FMD_R             SIM_REG(0x400FD004)
+#define FLASH_FMC_R             SIM_REG(0x400FD008)
+#define FLASH_FMC_WRKEY         0xA4420000
+#define FLASH_FMC_ERASE         0x00000002
+#define FLASH_FMC_WRITE         0x00000001
+
+//-----------------------------------------------------------------------------
+// System control registers
+//-----------------------------------------------------------------------------
+#define SYSCTL_RCC_R            SIM_REG(0x400FE060)
+#define SYSCTL_GPIOHBCTL_R      SIM_REG(0x400FE06C)
+#define SYSCTL_RCGC0_R          SIM_REG(0x400FE100)
+#define SYSCTL_RCGC2_R          SIM_REG(0x400FE108)
+#define SYSCTL_SRPWM_R          SIM_REG(0x400FE540)
+#define SYSCTL_SREEPROM_R       SIM_REG(0x400FE558)
+#define SYSCTL_RCGCTIMER_R      SIM_REG(0x400FE604)
+#define SYSCTL_RCGCDMA_R        SIM_REG(0x400FE60C)
+#define SYSCTL_RCGCUART_R       SIM_REG(0x400FE618)
+#define SYSCTL_RCGCPWM_R        SIM_REG(0x400FE640)
+#define SYSCTL_RCGCEEPROM_R     SIM_REG(0x400FE658)
+#define SYSCTL_RCGCWTIMER_R     SIM_REG(0x400FE65C)
+
+#define SYSCTL_RCC_USEPWMDIV    0x00100000
+#define SYSCTL_RCC_PWMDIV_16    0x00060000
+#define SYSCTL_RCC_USESYSDIV    0x00400000
+#define SYSCTL_RCC_SYSDIV_S     23
+#define SYSCTL_RCC_XTAL_16MHZ   0x00000540
+#define SYSCTL_RCC_OSCSRC_MAIN  0x00000000
+#define SYSCTL_RCGC0_PWM0       0x00100000
+#define SYSCTL_RCGC2_GPIOF      0x00000020
+#define SYSCTL_RCGC2_GPIOE      0x00000010
+#define SYSCTL_RCGC2_GPIOD      0x00000008
+#define SYSCTL_RCGC2_GPIOC      0x00000004
+#define SYSCTL_RCGC2_GPIOA      0x00000001
+#define SYSCTL_SREEPROM_R0      0x00000001
+#define SYSCTL_RCGCTIMER_R3     0x00000008
+#define SYSCTL_RCGCTIMER_R2     0x00000004
+#define SYSCTL_RCGCTIMER_R1     0x00000002
+#define SYSCTL_RCGCTIMER_R0     0x00000001
+#define SYSCTL_RCGCDMA_R0       0x00000001
+#define SYSCTL_RCGCUART_R7      0x00000080
+#define SYSCTL_RCGCUART_R6      0x00000040
+#define SYSCTL_RCGCUART_R5      0x00000020
+#define SYSCTL_RCGCUART_R3      0x00000008
+#define SYSCTL_RCGCUART_R2      0x00000004
+#define SYSCTL_RCGCUART_R1      0x00000002
+#define SYSCTL_RCGCUART_R0      0x00000001
+#define SYSCTL_RCGCPWM_R1       0x00000002
+#define SYSCTL_RCGCEEPROM_R0    0x00000001
+#define SYSCTL_RCGCWTIMER_R5    0x00000020
+
+//-----------------------------------------------------------------------------
+// uDMA registers
+//-----------------------------------------------------------------------------
+#define UDMA_CFG_R              SIM_REG(0x400FF004)
+#define UDMA_CTLBASE_R          SIM_REG(0x400FF008)
+#define UDMA_USEBURSTCLR_R      SIM_REG(0x400FF01C)
+#define UDMA_REQMASKCLR_R       SIM_REG(0x400FF024)
+#define UDMA_ENASET_R           SIM_REG(0x400FF028)
+#define UDMA_ENACLR_R           SIM_REG(0x400FF02C)
+#define UDMA_ALTCLR_R           SIM_REG(0x400FF034)
+#define UDMA_PRIOCLR_R          SIM_REG(0x400FF03C)
+#define UDMA_CHIS_R             SIM_REG(0x400FF504)
+#define UDMA_CHMAP2_R           SIM_REG(0x400FF518)
+
+#define UDMA_CFG_MASTEN         0x00000001
+#define UDMA_CHMAP2_CH23SEL_M   0xF0000000
+#define UDMA_CHMAP2_CH22SEL_M   0x0F000000
+#define UDMA_CHCTL_DSTINC_M     0xC0000000
+#define UDMA_CHCTL_DSTINC_8     0x00000000
+#define UDMA_CHCTL_DSTINC_NONE  0xC0000000
+#define UDMA_CHCTL_DSTSIZE_8    0x00000000
+#define UDMA_CHCTL_SRCINC_M     0x0C000000
+#define UDMA_CHCTL_SRCINC_8     0x00000000
+#define UDMA_CHCTL_SRCINC_NONE  0x0C000000
+#define UDMA_CHCTL_SRCSIZE_8    0x00000000
+#define UDMA_CHCTL_ARBSIZE_1    0x00000000
+#define UDMA_CHCTL_ARBSIZE_4    0x00008000
+#define UDMA_CHCTL_XFERSIZE_M   0x00003FF0
+#define UDMA_CHCTL_XFERSIZE_S   4
+#define UDMA_CHCTL_XFERMODE_M   0x00000007
+#define UDMA_CHCTL_XFERMODE_STOP 0x00000000
+#define UDMA_CHCTL_XFERMODE_BASIC 0x00000001
+
+//-----------------------------------------------------------------------------
+// NVIC registers
+//-----------------------------------------------------------------------------
+#define NVIC_EN0_R              SIM_REG(0xE000E100)
+#define NVIC_EN1_R              SIM_REG(0xE000E104)
+#define NVIC_EN3_R              SIM_REG(0xE000E10C)
+#define NVIC_DIS0_R             SIM_REG(0xE000E180)
+#define NVIC_PRI1_R             SIM_REG(0xE000E404)
+#define NVIC_PRI5_R             SIM_REG(0xE000E414)
+#define NVIC_SW_TRIG_R          SIM_REG(0xE000EF00)
+
+#define NVIC_PRI1_INTB_M        0x0000E000
+#define NVIC_PRI1_INTB_S        13
+#define NVIC_PRI5_INTB_M        0x0000E000
+#define NVIC_PRI5_INTB_S        13
+#define NVIC_PRI5_INTD_M        0xE0000000
+#define NVIC_PRI5_INTD_S        29
+
+#endif
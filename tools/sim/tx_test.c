@@ -0,0 +1,250 @@
+/**
+ * @file tx_test.c
+ * @brief Host test of the UART1 transmit engines against the peripheral double. <br>
+ * For txmode 0 (interrupt per slot), 2 (FIFO refill) and 1 (uDMA), checks every complete frame on the UART1 line:
+ * start code 0 and the 512 slots of the front universe, break and mark after break at least as long as set,
+ * and the UART1 interrupts taken per frame, counted by the double and by the firmware itself. Recording a scene
+ * holds the output between two frames for the flash erase.
+ */
+
+#define main firmwareMain
+#include "../../satej_matthew.c"
+#undef main
+
+#include <stdio.h>
+#include "double.h"
+
+int checks = 0; /*!< Checks made. */
+int failures = 0; /*!< Checks failed. */
+
+#define CHECK(c) check((c), #c, __LINE__)
+
+/**
+ * @brief
+ *
+ * Function to count a check and report it when it fails.
+ */
+void check(bool ok /**< [in] result */, const char* what /**< [in] checked expression */, int line /**< [in] source line */)
+{
+
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        fprintf(stderr, "tx_test.c:%d: failed: %s\n", line, what);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to start the firmware in controller mode, the way main() does after a reset.
+ */
+void boot()
+{
+
+    simInit();
+    simVector(INT_UART0, Uart0Isr);
+    simVector(INT_UART1, Uart1Isr);
+    simVector(INT_UART2, Uart2Isr);
+    simVector(INT_UART3, Uart3Isr);
+    simVector(INT_UART5, Uart5Isr);
+    simVector(INT_UART6, Uart6Isr);
+    simVector(INT_UART7, Uart7Isr);
+    simVector(INT_TIMER1A, Timer1ISR);
+    simVector(INT_TIMER2A, Timer2ISR);
+    simVector(INT_TIMER3A, Timer3ISR);
+    simVector(INT_WTIMER5A, WideTimer5ISR);
+    simIdle(serviceConsole);
+    simEeprom(0, 2, 1);
+    initHw();
+    getModeEE();
+    simConsole("controller");
+}
+
+/**
+ * @brief
+ *
+ * Function to write a level pattern into universe 1 through the back universe.
+ */
+void fillUniverse(uint8_t seed /**< [in] pattern seed */)
+{
+
+    uint16_t i;
+
+    beginDMXWrite(0);
+    for (i = 0; i < 512; ++i)
+    {
+        dmxData[i] = i * 7 + seed;
+    }
+    endDMXWrite(0);
+}
+
+/**
+ * @brief
+ *
+ * Function to check one frame seen on the UART1 line.
+ */
+void checkFrame(const simFrame* f /**< [in] logged frame */, uint8_t seed /**< [in] pattern seed */)
+{
+
+    uint16_t i;
+    uint16_t wrong = 0;
+
+    CHECK(f->count == 513);
+    CHECK(f->data[0] == 0);
+    for (i = 0; i < 512; ++i)
+    {
+        wrong += f->data[i + 1] != (uint8_t) (i * 7 + seed);
+    }
+    CHECK(wrong == 0);
+    CHECK(f->breakEnd - f->breakStart >= breakTime * 40);
+    CHECK(f->dataStart - f->breakEnd >= mabTime * 40);
+
+    //slots follow each other without idle time, whatever the engine
+    CHECK(f->dataEnd - f->dataStart == 513 * 44 * 40);
+}
+
+/**
+ * @brief
+ *
+ * Function to run one transmit engine continuously and check the frames it sends.
+ */
+void runMode(uint8_t m /**< [in] transmit mode */, uint8_t seed /**< [in] pattern seed */)
+{
+
+    char line[20];
+    uint16_t n;
+    uint16_t i;
+    const simFrame* f = 0;
+
+    //let the frame in progress end before switching
+    simConsole("off");
+    simRun(30000);
+    sprintf(line, "txmode %u", m);
+    simConsole(line);
+    fillUniverse(seed);
+    simFramesClear(1);
+    simConsole("on");
+    simRun(100000);
+
+    //the last frame is still being sent
+    n = simFrameCount(1);
+    CHECK(n >= 4);
+    for (i = 0; i + 1 < n; ++i)
+    {
+        f = simFrameAt(1, i);
+        checkFrame(f, seed);
+        if (m == 0)
+        {
+            //start code and every slot interrupt, one per character
+            CHECK(f->isrs == 513);
+        }
+        else if (m == 1)
+        {
+            //uDMA completion and end of transmission
+            CHECK(f->isrs == 2);
+        }
+        else
+        {
+            //14 slots per refill and end of transmission
+            CHECK(f->isrs * 10 < 513);
+        }
+    }
+    if (f)
+    {
+        CHECK(txIsrPerFrame == f->isrs);
+        printf("txmode %u: %u frames, %lu us break to break, %u UART1 interrupts per frame\n", m, n - 1,
+               (unsigned long) ((simFrameAt(1, 1)->breakStart - simFrameAt(1, 0)->breakStart) / 40), f->isrs);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to check that a universe written during a frame goes out whole from the next break on.
+ */
+void runPublish()
+{
+
+    uint16_t n;
+    uint16_t i;
+
+    simConsole("off");
+    simRun(30000);
+    simConsole("txmode 1");
+    fillUniverse(1);
+    simFramesClear(1);
+    simConsole("on");
+    simRun(10000);
+    fillUniverse(2);
+    simRun(50000);
+    n = simFrameCount(1);
+    CHECK(n >= 2);
+    checkFrame(simFrameAt(1, 0), 1);
+    for (i = 1; i + 1 < n; ++i)
+    {
+        checkFrame(simFrameAt(1, i), 2);
+    }
+}
+
+/**
+ * @brief
+ *
+ * Function to check that recording a scene, which stalls the CPU on a flash erase and program, holds the output
+ * at mark between two frames instead of cutting one short, and that the output carries on afterwards.
+ */
+void runRecord()
+{
+
+    uint16_t n;
+    uint16_t i;
+    uint32_t longest = 0;
+
+    simConsole("off");
+    simRun(30000);
+    simConsole("txmode 0");
+    fillUniverse(15);
+    simFramesClear(1);
+    simConsole("on");
+    simRun(10000);
+    simConsole("record 3");
+    simRun(60000);
+    n = simFrameCount(1);
+    CHECK(n >= 4);
+    for (i = 0; i + 1 < n; ++i)
+    {
+        checkFrame(simFrameAt(1, i), 15);
+        if (i > 0 && simFrameAt(1, i)->breakStart - simFrameAt(1, i - 1)->breakStart > longest)
+        {
+            longest = simFrameAt(1, i)->breakStart - simFrameAt(1, i - 1)->breakStart;
+        }
+    }
+
+    //one period spans the erase
+    CHECK(longest > 15000 * 40);
+    CHECK(memcmp((const void*) (SCENE_BASE + 3 * 512), dmxFront, 512) == 0);
+    printf("record: %u frames, %lu us longest break to break\n", n - 1, (unsigned long) (longest / 40));
+}
+
+/**
+ * @brief
+ *
+ * Function to run the transmit tests.
+ */
+int main()
+{
+
+    boot();
+    runMode(0, 3);
+    runMode(2, 5);
+    runMode(1, 9);
+    simConsole("break 200");
+    simConsole("mab 40");
+    runMode(1, 11);
+    runMode(0, 13);
+    runPublish();
+    runRecord();
+    printf("tx_test: %d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}